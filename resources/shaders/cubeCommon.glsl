@@ -0,0 +1,5 @@
+// Shared by the cube shaders, included after the version directive
+
+vec4 unpackColor(uint color) {
+	return vec4(color & 0xFFu, (color >> 8) & 0xFFu, (color >> 16) & 0xFFu, color >> 24) / 255.0;
+}
\ No newline at end of file
@@ -2,16 +2,24 @@
 out vec4 FragColor;
 
 in vec2 texCoord;
+in vec4 faceColor;
+flat in int textureLayer;
 
-uniform vec4 color;
-uniform bool hasTexture;
-uniform sampler2D texture1;
+#ifdef TEXTURED
+uniform sampler2DArray textures;
+#endif
 
 void main()
 {
-	if (hasTexture) {
-		FragColor = texture(texture1, texCoord);
-	} else {
-		FragColor = color;
-	}
+	vec4 color = faceColor;
+#ifdef TEXTURED
+	// Same for the whole face, so neighbouring fragments never diverge
+	if (textureLayer >= 0)
+		color = texture(textures, vec3(texCoord, textureLayer));
+#endif
+#ifdef ALPHA_TESTED
+	if (color.a < 0.5)
+		discard;
+#endif
+	FragColor = color;
 }
\ No newline at end of file
@@ -1,14 +1,51 @@
 #version 330 core
+#include "cubeCommon.glsl"
+#include "frameUniforms.glsl"
+
+#ifdef INSTANCED
+layout (location = 0) in vec2 corner;
+
+// Per face instance
+layout (location = 1) in vec3 origin;
+layout (location = 2) in vec3 edgeU;
+layout (location = 3) in vec3 edgeV;
+layout (location = 4) in vec4 uvRect;
+layout (location = 5) in uint color;
+layout (location = 6) in ivec3 faceInfo;	// Texture layer, orientation, rotation
+#else
+// Baked mesh
 layout (location = 0) in vec3 position;
 layout (location = 1) in vec2 textureCoordinate;
+layout (location = 2) in uint color;
+layout (location = 3) in int layer;
+#endif
 
 out vec2 texCoord;
+out vec4 faceColor;
+flat out int textureLayer;
 
-uniform mat4 modelMatrix;
-uniform mat4 viewMatrix;
-uniform mat4 projectionMatrix;
+#ifdef INSTANCED
+vec2 rotateCorner(vec2 corner, int quarterTurns) {
+	for (int i = 0; i < quarterTurns; ++i) {
+		corner = vec2(corner.y, 1.0 - corner.x);
+	}
+	return corner;
+}
+
+void main() {
+	vec3 position = origin + corner.x * edgeU + corner.y * edgeV;
+	gl_Position = viewProjectionMatrix * vec4(position, 1.0);
 
+	vec2 rotatedCorner = rotateCorner(corner, faceInfo.z);
+	texCoord = mix(uvRect.xy, uvRect.zw, rotatedCorner);
+	faceColor = unpackColor(color);
+	textureLayer = faceInfo.x;
+}
+#else
 void main() {
-	gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(position, 1.0);
+	gl_Position = viewProjectionMatrix * vec4(position, 1.0);
 	texCoord = textureCoordinate;
-}
\ No newline at end of file
+	faceColor = unpackColor(color);
+	textureLayer = layer;
+}
+#endif
\ No newline at end of file
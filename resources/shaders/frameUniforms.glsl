@@ -0,0 +1,9 @@
+// Written once per frame by render::FrameUniforms, the layout has to match its Data struct
+
+layout (std140) uniform FrameUniforms {
+	mat4 viewMatrix;
+	mat4 projectionMatrix;
+	mat4 viewProjectionMatrix;
+	vec2 viewportSize;
+	float time;
+};
\ No newline at end of file
@@ -0,0 +1,48 @@
+#version 330 core
+
+// Fast approximate anti-aliasing, blurs along the edges it finds in an image that was drawn without multisampling
+
+out vec4 FragColor;
+
+in vec2 textureCoord;
+
+uniform sampler2D texture1;
+uniform vec2 texelSize;
+
+const vec3 LUMA = vec3(0.299, 0.587, 0.114);
+// Longest blur along an edge in pixels
+const float SPAN_MAX = 8.0;
+const float REDUCE_MIN = 1.0 / 128.0;
+const float REDUCE_MULTIPLIER = 1.0 / 8.0;
+
+void main()
+{
+	float lumaNorthWest = dot(texture(texture1, textureCoord + vec2(-1.0, -1.0) * texelSize).rgb, LUMA);
+	float lumaNorthEast = dot(texture(texture1, textureCoord + vec2(1.0, -1.0) * texelSize).rgb, LUMA);
+	float lumaSouthWest = dot(texture(texture1, textureCoord + vec2(-1.0, 1.0) * texelSize).rgb, LUMA);
+	float lumaSouthEast = dot(texture(texture1, textureCoord + vec2(1.0, 1.0) * texelSize).rgb, LUMA);
+	vec4 middle = texture(texture1, textureCoord);
+	float lumaMiddle = dot(middle.rgb, LUMA);
+
+	float lumaMin = min(lumaMiddle, min(min(lumaNorthWest, lumaNorthEast), min(lumaSouthWest, lumaSouthEast)));
+	float lumaMax = max(lumaMiddle, max(max(lumaNorthWest, lumaNorthEast), max(lumaSouthWest, lumaSouthEast)));
+
+	// Along the edge, perpendicular to the direction the brightness changes in
+	vec2 direction = vec2(
+		-((lumaNorthWest + lumaNorthEast) - (lumaSouthWest + lumaSouthEast)),
+		(lumaNorthWest + lumaSouthWest) - (lumaNorthEast + lumaSouthEast));
+	float directionReduce = max((lumaNorthWest + lumaNorthEast + lumaSouthWest + lumaSouthEast) * 0.25 * REDUCE_MULTIPLIER, REDUCE_MIN);
+	float inverseDirectionMin = 1.0 / (min(abs(direction.x), abs(direction.y)) + directionReduce);
+	direction = clamp(direction * inverseDirectionMin, vec2(-SPAN_MAX), vec2(SPAN_MAX)) * texelSize;
+
+	vec4 nearBlur = 0.5 * (
+		texture(texture1, textureCoord + direction * (1.0 / 3.0 - 0.5)) +
+		texture(texture1, textureCoord + direction * (2.0 / 3.0 - 0.5)));
+	vec4 farBlur = nearBlur * 0.5 + 0.25 * (
+		texture(texture1, textureCoord + direction * -0.5) +
+		texture(texture1, textureCoord + direction * 0.5));
+
+	// The wider blur crossed another edge when it leaves the range around this pixel
+	float lumaFar = dot(farBlur.rgb, LUMA);
+	FragColor = (lumaFar < lumaMin || lumaFar > lumaMax) ? nearBlur : farBlur;
+}
\ No newline at end of file
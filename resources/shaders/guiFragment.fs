@@ -4,15 +4,25 @@ out vec4 FragColor;
 
 in vec2 textureCoord;
 
-uniform vec4 color;
-uniform bool hasTexture;
+#ifdef TEXTURED
 uniform sampler2D texture1;
+#endif
+#if !defined(TEXTURED) || defined(GLYPH)
+uniform vec4 color;
+#endif
 
 void main()
 {
-	if (hasTexture) {
-		FragColor = texture(texture1, textureCoord);
-	} else {
-		FragColor = color;
-	}
+#if defined(TEXTURED) && defined(GLYPH)
+	// The atlas only holds how much of each pixel the glyph covers
+	FragColor = vec4(color.rgb, color.a * texture(texture1, textureCoord).a);
+#elif defined(TEXTURED)
+	FragColor = texture(texture1, textureCoord);
+#else
+	FragColor = color;
+#endif
+#ifdef ALPHA_TESTED
+	if (FragColor.a < 0.5)
+		discard;
+#endif
 }
\ No newline at end of file
@@ -6,9 +6,17 @@ layout (location = 1) in vec2 textureCoordIn;
 out vec2 textureCoord;
 
 uniform mat4 transformation;
+#ifdef GLYPH
+// Offset and size of the glyph in the atlas
+uniform vec4 textureRegion;
+#endif
 
 void main()
 {
+#ifdef GLYPH
+	textureCoord = textureRegion.xy + textureCoordIn * textureRegion.zw;
+#else
 	textureCoord = textureCoordIn;
+#endif
 	gl_Position = transformation * vec4(position, 0.0, 1.0);
 }
\ No newline at end of file
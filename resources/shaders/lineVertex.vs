@@ -1,10 +1,10 @@
 #version 330 core
+#include "frameUniforms.glsl"
+
 layout (location = 0) in vec3 position;
 
 uniform mat4 modelMatrix;
-uniform mat4 viewMatrix;
-uniform mat4 projectionMatrix;
 
 void main() {
-	gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(position, 1.0);
+	gl_Position = viewProjectionMatrix * modelMatrix * vec4(position, 1.0);
 }
\ No newline at end of file
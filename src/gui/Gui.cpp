@@ -6,9 +6,11 @@
 #include <ctype.h>
 #include <stdlib.h>
 #include <algorithm>
+#include <utility>
+#include <limits>
+#include <cmath>
 
 #include "../import/Shader.h"
-#include "../import/stb_image.h"
 #include "Gui.h"
 
 static const int DEFAULT_WINDOW_WIDTH = 640;
@@ -16,9 +18,35 @@ static const int DEFAULT_WINDOW_HEIGHT = 480;
 
 static const std::string vertexShaderPath = "resources/shaders/guiVertex.vs";
 static const std::string fragmentShaderPath = "resources/shaders/guiFragment.fs";
+// Uniforms of the gui shader, looked up by their hash
+static constexpr UniformName COLOR_UNIFORM = "color";
+static constexpr UniformName TRANSFORMATION_UNIFORM = "transformation";
+static constexpr UniformName TEXTURE_REGION_UNIFORM = "textureRegion";
 
 static const unsigned int CHARACTER_OFFSET = 32;
+static const int CHARACTER_COUNT = 95;
+
+// Glyphs are drawn once, so they can afford more samples than the viewport
+static const int GLYPH_SAMPLE_COUNT = 8;
+// Glyph atlases wrap into a new row of glyphs at this width
+static const int GLYPH_ATLAS_WIDTH = 1024;
+// Empty pixels between glyphs, so sampling near the edge of one never reaches the next
+static const int GLYPH_PADDING = 1;
+
+// Shown until the image of a texture is decoded
+static const unsigned char PLACEHOLDER_PIXEL[] = { 0, 0, 0, 0 };
+
+// Vertex sizes in the shared vertex arena, also used as alignment so offsets convert to a first vertex
+static const int QUAD_VERTEX_SIZE = 4 * sizeof(float);
+static const int CHARACTER_VERTEX_SIZE = 2 * sizeof(float);
 static const char DECIMAL_SEPERATOR = '.';
+// Time the insert line of text inputs stays shown or hidden
+static const double INSERT_LINE_BLINK_INTERVAL = 0.5;
+static const double NO_REDRAW_TIME = std::numeric_limits<double>::infinity();
+// Frame caps while in the background or minimized, the foreground is only limited by the monitor
+// Frames are still drawn in these states to pick up finished work
+static const double DEFAULT_BACKGROUND_FRAME_CAP = 30.0;
+static const double DEFAULT_MINIMIZED_FRAME_CAP = 2.0;
 static const char NEGATIVE_SYMBOL = '-';
 
 static const gui::Boundary screenBoundary = {
@@ -44,6 +72,7 @@ void gui::Gui::init(int windowWidth, int windowHeight) {
 	Gui::keyManager = new KeyManager();
 	Gui::mouseManager = new MouseManager();
 	Gui::resizeManager = new ResizeManager();
+	Gui::timers = new TimerWheel();
 
 	Gui::mainWindow = new gui::OGLWindow(windowWidth, windowHeight);
 
@@ -57,7 +86,10 @@ void gui::Gui::init(int windowWidth, int windowHeight) {
 	}
 
 	// Set up openGL stuff like shader, vao and font characters
-	Gui::shader = new Shader(vertexShaderPath, fragmentShaderPath);
+	Gui::shaders = new ShaderVariants(vertexShaderPath, fragmentShaderPath);
+	Gui::shaders->prepare(0);
+	Gui::shaders->prepare(SHADER_TEXTURED);
+	Gui::shaders->prepare(SHADER_TEXTURED | SHADER_GLYPH);
 	Gui::loadQuadVAO();
 	Gui::loadAllCharacters();
 
@@ -90,9 +122,9 @@ glm::mat4 gui::Gui::getTransformationMatrix(Boundary boundary) {
 unsigned int gui::Gui::loadTexture(std::string pathToFile) {
 	// TODO test init
 
-	unsigned int textureID;
-	glGenTextures(1, &textureID);
-	glBindTexture(GL_TEXTURE_2D, textureID);
+	render::Texture texture = render::Texture::create();
+	unsigned int textureID = texture.getID();
+	render::GlState::getInstance()->bindTexture(GL_TEXTURE_2D, textureID);
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -101,19 +133,49 @@ unsigned int gui::Gui::loadTexture(std::string pathToFile) {
 	//glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-	int width, height, numberOfChannels;
-	unsigned char* data = stbi_load(pathToFile.c_str(), &width, &height, &numberOfChannels, 0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, PLACEHOLDER_PIXEL);
 
 	std::cout << "Loading: " << pathToFile << std::endl;
 
-	if (data) {
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-	}
+	// The image replaces the placeholder once it is decoded, the texture ID stays the same
+	render::TextureLoader* loader = render::TextureLoader::getInstance();
+	loader->load(pathToFile, [textureID, loader](render::DecodedImage* image) {
+		if (!image->succeeded) {
+			std::cout << "Failed to load texture: " << image->path << std::endl;
+			return;
+		}
+
+		// All levels are staged at once, each is read from its own offset
+		render::GlState::getInstance()->bindTexture(GL_TEXTURE_2D, textureID);
+		loader->beginUpload(image->getPixels(0), image->getPixelDataSize());
+		for (int level = 0; level < image->levelCount; ++level) {
+			intptr_t offset = image->getLevelOffset(level) - image->getLevelOffset(0);
+			glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, image->getLevelWidth(level), image->getLevelHeight(level), 0, GL_RGBA, GL_UNSIGNED_BYTE, (void*)offset);
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image->levelCount - 1);
+		loader->endUpload();
+	});
 	//glGenerateMipmap(GL_TEXTURE_2D);
-	stbi_image_free(data);
 
+	Gui::textures.push_back(std::move(texture));
 	return textureID;
 }
+Shader* gui::Gui::getShader(bool isTextured) {
+	return Gui::shaders->get(isTextured ? SHADER_TEXTURED : 0);
+}
+Shader* gui::Gui::getGlyphShader() {
+	return Gui::shaders->get(SHADER_TEXTURED | SHADER_GLYPH);
+}
+gui::GlyphAtlas* gui::Gui::getGlyphAtlas(int fontSize) {
+	std::unique_ptr<GlyphAtlas>& atlas = Gui::glyphAtlases[fontSize];
+	if (!atlas)
+		atlas.reset(new GlyphAtlas(fontSize));
+	return atlas.get();
+}
+int gui::Gui::getQuadFirstVertex() {
+	return render::BufferArena::getVertexArena()->getOffset(Gui::quadAllocation) / QUAD_VERTEX_SIZE;
+}
 gui::Character gui::Gui::getCharacter(char c) {
 	int index = ((int) c) - CHARACTER_OFFSET;
 	return gui::Gui::characters[index];
@@ -128,27 +190,24 @@ void gui::Gui::loadQuadVAO() {
 			-1.0f,  1.0f,		0.0f, 0.0f
 	};
 
-	unsigned int VAO;
-	glGenVertexArrays(1, &VAO);
-	glBindVertexArray(VAO);
+	render::BufferArena* vertexArena = render::BufferArena::getVertexArena();
+	Gui::quadAllocation = vertexArena->allocate(sizeof(vertices), QUAD_VERTEX_SIZE);
+	vertexArena->upload(Gui::quadAllocation, vertices, sizeof(vertices));
 
-	unsigned int VBO;
-	glGenBuffers(1, &VBO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	Gui::quadVAO = render::VertexArray::create();
+	Gui::quadVAO.bind();
+	glBindBuffer(GL_ARRAY_BUFFER, vertexArena->getBufferID());
 
 	// Pointer to vertices
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, QUAD_VERTEX_SIZE, (void*)0);
 	glEnableVertexAttribArray(0);
 
 	// Pointer to texture coordinates
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, QUAD_VERTEX_SIZE, (void*)(2 * sizeof(float)));
 	glEnableVertexAttribArray(1);
 
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
-
-	Gui::quadVAO = VAO;
+	render::GlState::getInstance()->bindVertexArray(0);
 }
 void gui::Gui::initialiseGLFW() {
 	std::cout << "3. Initialising GLFW" << std::endl;
@@ -156,16 +215,25 @@ void gui::Gui::initialiseGLFW() {
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-	glfwWindowHint(GLFW_SAMPLES, 8);
+	// Only the model viewport and glyphs are multisampled, in their own render targets
+	glfwWindowHint(GLFW_SAMPLES, 0);
 }
 void gui::Gui::loadAllCharacters() {
 	
-	gui::Gui::characters = std::vector<gui::Character>(95);
+	gui::Gui::characters = std::vector<gui::Character>(CHARACTER_COUNT);
+
+	// All glyphs share one vertex array, they only differ in their first vertex
+	Gui::characterVAO = render::VertexArray::create();
+	Gui::characterVAO.bind();
+	glBindBuffer(GL_ARRAY_BUFFER, render::BufferArena::getVertexArena()->getBufferID());
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, CHARACTER_VERTEX_SIZE, (void*)0);
+	glEnableVertexAttribArray(0);
+	render::GlState::getInstance()->bindVertexArray(0);
 
 	// space
 	float spaceVertices[] = {
 		-1.0f, -1.0f, };
-	Gui::characters[0].vao = gui::Gui::loadCharacterVertices(spaceVertices, sizeof(spaceVertices));
+	Gui::characters[0].allocation = gui::Gui::loadCharacterVertices(spaceVertices, sizeof(spaceVertices));
 	Gui::characters[0].width = 0.13f;
 
 	// exclam
@@ -181,7 +249,7 @@ void gui::Gui::loadAllCharacters() {
 		-1.0f, 0.818070818070818f,
 		1.0f, 0.818070818070818f,
 	};
-	Gui::characters[1].vao = gui::Gui::loadCharacterVertices(exclamVertices, sizeof(exclamVertices));
+	Gui::characters[1].allocation = gui::Gui::loadCharacterVertices(exclamVertices, sizeof(exclamVertices));
 	Gui::characters[1].ranges.push_back({ 0, 4 });
 	Gui::characters[1].ranges.push_back({ 4, 4 });
 	Gui::characters[1].width = 0.13675213675213677f;
@@ -199,7 +267,7 @@ void gui::Gui::loadAllCharacters() {
 		0.265993265993266f, 0.8998778998778999f,
 		1.0f, 0.8998778998778999f,
 	};
-	Gui::characters[2].vao = gui::Gui::loadCharacterVertices(quotedblVertices, sizeof(quotedblVertices));
+	Gui::characters[2].allocation = gui::Gui::loadCharacterVertices(quotedblVertices, sizeof(quotedblVertices));
 	Gui::characters[2].ranges.push_back({ 0, 4 });
 	Gui::characters[2].ranges.push_back({ 4, 4 });
 	Gui::characters[2].width = 0.3626373626373626f;
@@ -227,7 +295,7 @@ void gui::Gui::loadAllCharacters() {
 		1.0f, 0.13797313797313793f,
 		1.0f, 0.30280830280830284f,
 	};
-	Gui::characters[3].vao = gui::Gui::loadCharacterVertices(numbersignVertices, sizeof(numbersignVertices));
+	Gui::characters[3].allocation = gui::Gui::loadCharacterVertices(numbersignVertices, sizeof(numbersignVertices));
 	Gui::characters[3].ranges.push_back({ 0, 4 });
 	Gui::characters[3].ranges.push_back({ 4, 4 });
 	Gui::characters[3].ranges.push_back({ 8, 4 });
@@ -279,7 +347,7 @@ void gui::Gui::loadAllCharacters() {
 		0.8954248366013071f, 0.503052503052503f,
 		0.8954248366013071f, 0.26129426129426125f,
 	};
-	Gui::characters[4].vao = gui::Gui::loadCharacterVertices(dollarVertices, sizeof(dollarVertices));
+	Gui::characters[4].allocation = gui::Gui::loadCharacterVertices(dollarVertices, sizeof(dollarVertices));
 	Gui::characters[4].ranges.push_back({ 0, 4 });
 	Gui::characters[4].ranges.push_back({ 4, 36 });
 	Gui::characters[4].width = 0.5604395604395604f;
@@ -362,7 +430,7 @@ void gui::Gui::loadAllCharacters() {
 		0.21448467966573825f, -0.49694749694749696f,
 		0.4128133704735375f, -0.49694749694749696f,
 	};
-	Gui::characters[5].vao = gui::Gui::loadCharacterVertices(percentVertices, sizeof(percentVertices));
+	Gui::characters[5].allocation = gui::Gui::loadCharacterVertices(percentVertices, sizeof(percentVertices));
 	Gui::characters[5].ranges.push_back({ 0, 34 });
 	Gui::characters[5].ranges.push_back({ 34, 4 });
 	Gui::characters[5].ranges.push_back({ 38, 34 });
@@ -431,7 +499,7 @@ void gui::Gui::loadAllCharacters() {
 		0.35123367198838906f, 0.10989010989010994f,
 		0.6342525399129173f, 0.10989010989010994f,
 	};
-	Gui::characters[6].vao = gui::Gui::loadCharacterVertices(ampersandVertices, sizeof(ampersandVertices));
+	Gui::characters[6].allocation = gui::Gui::loadCharacterVertices(ampersandVertices, sizeof(ampersandVertices));
 	Gui::characters[6].ranges.push_back({ 0, 59 });
 	Gui::characters[6].width = 0.8412698412698413f;
 
@@ -443,7 +511,7 @@ void gui::Gui::loadAllCharacters() {
 		-1.0f, 0.8998778998778999f,
 		1.0f, 0.8998778998778999f,
 	};
-	Gui::characters[7].vao = gui::Gui::loadCharacterVertices(quotesingleVertices, sizeof(quotesingleVertices));
+	Gui::characters[7].allocation = gui::Gui::loadCharacterVertices(quotesingleVertices, sizeof(quotesingleVertices));
 	Gui::characters[7].ranges.push_back({ 0, 4 });
 	Gui::characters[7].width = 0.13553113553113552f;
 
@@ -471,7 +539,7 @@ void gui::Gui::loadAllCharacters() {
 		1.0f, 0.8876678876678876f,
 		1.0f, 0.8998778998778999f,
 	};
-	Gui::characters[8].vao = gui::Gui::loadCharacterVertices(parenleftVertices, sizeof(parenleftVertices));
+	Gui::characters[8].allocation = gui::Gui::loadCharacterVertices(parenleftVertices, sizeof(parenleftVertices));
 	Gui::characters[8].ranges.push_back({ 0, 20 });
 	Gui::characters[8].width = 0.36752136752136755f;
 
@@ -499,7 +567,7 @@ void gui::Gui::loadAllCharacters() {
 		-1.0f, 0.8876678876678876f,
 		-1.0f, 0.8998778998778999f,
 	};
-	Gui::characters[9].vao = gui::Gui::loadCharacterVertices(parenrightVertices, sizeof(parenrightVertices));
+	Gui::characters[9].allocation = gui::Gui::loadCharacterVertices(parenrightVertices, sizeof(parenrightVertices));
 	Gui::characters[9].ranges.push_back({ 0, 20 });
 	Gui::characters[9].width = 0.36752136752136755f;
 
@@ -521,7 +589,7 @@ void gui::Gui::loadAllCharacters() {
 		0.8547486033519553f, -0.05128205128205132f,
 		1.0f, 0.08302808302808307f,
 	};
-	Gui::characters[10].vao = gui::Gui::loadCharacterVertices(asteriskVertices, sizeof(asteriskVertices));
+	Gui::characters[10].allocation = gui::Gui::loadCharacterVertices(asteriskVertices, sizeof(asteriskVertices));
 	Gui::characters[10].ranges.push_back({ 0, 4 });
 	Gui::characters[10].ranges.push_back({ 4, 4 });
 	Gui::characters[10].ranges.push_back({ 8, 4 });
@@ -540,7 +608,7 @@ void gui::Gui::loadAllCharacters() {
 		1.0f, -0.3015873015873016f,
 		1.0f, -0.1062271062271063f,
 	};
-	Gui::characters[11].vao = gui::Gui::loadCharacterVertices(plusVertices, sizeof(plusVertices));
+	Gui::characters[11].allocation = gui::Gui::loadCharacterVertices(plusVertices, sizeof(plusVertices));
 	Gui::characters[11].ranges.push_back({ 0, 4 });
 	Gui::characters[11].ranges.push_back({ 4, 4 });
 	Gui::characters[11].width = 0.717948717948718f;
@@ -553,7 +621,7 @@ void gui::Gui::loadAllCharacters() {
 		-0.17370892018779338f, -0.6520146520146519f,
 		1.0f, -0.6520146520146519f,
 	};
-	Gui::characters[12].vao = gui::Gui::loadCharacterVertices(commaVertices, sizeof(commaVertices));
+	Gui::characters[12].allocation = gui::Gui::loadCharacterVertices(commaVertices, sizeof(commaVertices));
 	Gui::characters[12].ranges.push_back({ 0, 4 });
 	Gui::characters[12].width = 0.2600732600732601f;
 
@@ -565,7 +633,7 @@ void gui::Gui::loadAllCharacters() {
 		1.0f, -0.315018315018315f,
 		1.0f, -0.09401709401709413f,
 	};
-	Gui::characters[13].vao = gui::Gui::loadCharacterVertices(hyphenVertices, sizeof(hyphenVertices));
+	Gui::characters[13].allocation = gui::Gui::loadCharacterVertices(hyphenVertices, sizeof(hyphenVertices));
 	Gui::characters[13].ranges.push_back({ 0, 4 });
 	Gui::characters[13].width = 0.3443223443223443f;
 
@@ -577,7 +645,7 @@ void gui::Gui::loadAllCharacters() {
 		-1.0f, -0.6520146520146519f,
 		1.0f, -0.6520146520146519f,
 	};
-	Gui::characters[14].vao = gui::Gui::loadCharacterVertices(periodVertices, sizeof(periodVertices));
+	Gui::characters[14].allocation = gui::Gui::loadCharacterVertices(periodVertices, sizeof(periodVertices));
 	Gui::characters[14].ranges.push_back({ 0, 4 });
 	Gui::characters[14].width = 0.14590964590964592f;
 
@@ -589,7 +657,7 @@ void gui::Gui::loadAllCharacters() {
 		0.5425531914893618f, 0.8998778998778999f,
 		1.0f, 0.8998778998778999f,
 	};
-	Gui::characters[15].vao = gui::Gui::loadCharacterVertices(slashVertices, sizeof(slashVertices));
+	Gui::characters[15].allocation = gui::Gui::loadCharacterVertices(slashVertices, sizeof(slashVertices));
 	Gui::characters[15].ranges.push_back({ 0, 4 });
 	Gui::characters[15].width = 0.4590964590964591f;
 
@@ -636,7 +704,7 @@ void gui::Gui::loadAllCharacters() {
 		-0.46638655462184875f, -0.641025641025641f,
 		-0.29306722689075626f, -0.7857142857142858f,
 	};
-	Gui::characters[16].vao = gui::Gui::loadCharacterVertices(zeroVertices, sizeof(zeroVertices));
+	Gui::characters[16].allocation = gui::Gui::loadCharacterVertices(zeroVertices, sizeof(zeroVertices));
 	Gui::characters[16].ranges.push_back({ 0, 34 });
 	Gui::characters[16].ranges.push_back({ 34, 4 });
 	Gui::characters[16].width = 0.5811965811965812f;
@@ -662,7 +730,7 @@ void gui::Gui::loadAllCharacters() {
 		-1.0f, 0.5702075702075702f,
 		-1.0f, 0.40415140415140416f,
 	};
-	Gui::characters[17].vao = gui::Gui::loadCharacterVertices(oneVertices, sizeof(oneVertices));
+	Gui::characters[17].allocation = gui::Gui::loadCharacterVertices(oneVertices, sizeof(oneVertices));
 	Gui::characters[17].ranges.push_back({ 0, 4 });
 	Gui::characters[17].ranges.push_back({ 4, 12 });
 	Gui::characters[17].width = 0.4432234432234432f;
@@ -700,7 +768,7 @@ void gui::Gui::loadAllCharacters() {
 		-0.9325353645266594f, 0.746031746031746f,
 		-0.9325353645266594f, 0.4871794871794872f,
 	};
-	Gui::characters[18].vao = gui::Gui::loadCharacterVertices(twoVertices, sizeof(twoVertices));
+	Gui::characters[18].allocation = gui::Gui::loadCharacterVertices(twoVertices, sizeof(twoVertices));
 	Gui::characters[18].ranges.push_back({ 0, 29 });
 	Gui::characters[18].width = 0.561050061050061f;
 
@@ -756,7 +824,7 @@ void gui::Gui::loadAllCharacters() {
 		-0.8828729281767955f, 0.485958485958486f,
 		-0.9093922651933701f, 0.485958485958486f,
 	};
-	Gui::characters[19].vao = gui::Gui::loadCharacterVertices(threeVertices, sizeof(threeVertices));
+	Gui::characters[19].allocation = gui::Gui::loadCharacterVertices(threeVertices, sizeof(threeVertices));
 	Gui::characters[19].ranges.push_back({ 0, 48 });
 	Gui::characters[19].width = 0.5525030525030525f;
 
@@ -773,7 +841,7 @@ void gui::Gui::loadAllCharacters() {
 		1.0f, -0.17948717948717952f,
 		1.0f, -0.37484737484737485f,
 	};
-	Gui::characters[20].vao = gui::Gui::loadCharacterVertices(fourVertices, sizeof(fourVertices));
+	Gui::characters[20].allocation = gui::Gui::loadCharacterVertices(fourVertices, sizeof(fourVertices));
 	Gui::characters[20].ranges.push_back({ 0, 9 });
 	Gui::characters[20].width = 0.626984126984127f;
 
@@ -812,7 +880,7 @@ void gui::Gui::loadAllCharacters() {
 		0.9797068771138671f, 0.6043956043956045f,
 		0.9797068771138671f, 0.818070818070818f,
 	};
-	Gui::characters[21].vao = gui::Gui::loadCharacterVertices(fiveVertices, sizeof(fiveVertices));
+	Gui::characters[21].allocation = gui::Gui::loadCharacterVertices(fiveVertices, sizeof(fiveVertices));
 	Gui::characters[21].ranges.push_back({ 0, 31 });
 	Gui::characters[21].width = 0.5415140415140415f;
 
@@ -864,7 +932,7 @@ void gui::Gui::loadAllCharacters() {
 		-0.5755693581780539f, -0.13919413919413914f,
 		-0.5755693581780539f, 0.03418803418803418f,
 	};
-	Gui::characters[22].vao = gui::Gui::loadCharacterVertices(sixVertices, sizeof(sixVertices));
+	Gui::characters[22].allocation = gui::Gui::loadCharacterVertices(sixVertices, sizeof(sixVertices));
 	Gui::characters[22].ranges.push_back({ 0, 44 });
 	Gui::characters[22].width = 0.5897435897435898f;
 
@@ -879,7 +947,7 @@ void gui::Gui::loadAllCharacters() {
 		-1.0f, 0.6043956043956045f,
 		-1.0f, 0.818070818070818f,
 	};
-	Gui::characters[23].vao = gui::Gui::loadCharacterVertices(sevenVertices, sizeof(sevenVertices));
+	Gui::characters[23].allocation = gui::Gui::loadCharacterVertices(sevenVertices, sizeof(sevenVertices));
 	Gui::characters[23].ranges.push_back({ 0, 7 });
 	Gui::characters[23].width = 0.5769230769230769f;
 
@@ -944,7 +1012,7 @@ void gui::Gui::loadAllCharacters() {
 		0.45567010309278344f, -0.039072039072039155f,
 		0.21237113402061847f, 0.02930402930402931f,
 	};
-	Gui::characters[24].vao = gui::Gui::loadCharacterVertices(eightVertices, sizeof(eightVertices));
+	Gui::characters[24].allocation = gui::Gui::loadCharacterVertices(eightVertices, sizeof(eightVertices));
 	Gui::characters[24].ranges.push_back({ 0, 57 });
 	Gui::characters[24].width = 0.5921855921855922f;
 
@@ -997,7 +1065,7 @@ void gui::Gui::loadAllCharacters() {
 		0.5734989648033126f, -0.21733821733821723f,
 		0.5755693581780539f, -0.04395604395604402f,
 	};
-	Gui::characters[25].vao = gui::Gui::loadCharacterVertices(nineVertices, sizeof(nineVertices));
+	Gui::characters[25].allocation = gui::Gui::loadCharacterVertices(nineVertices, sizeof(nineVertices));
 	Gui::characters[25].ranges.push_back({ 0, 45 });
 	Gui::characters[25].width = 0.5897435897435898f;
 
@@ -1014,7 +1082,7 @@ void gui::Gui::loadAllCharacters() {
 		-1.0f, 0.3638583638583639f,
 		1.0f, 0.3638583638583639f,
 	};
-	Gui::characters[26].vao = gui::Gui::loadCharacterVertices(colonVertices, sizeof(colonVertices));
+	Gui::characters[26].allocation = gui::Gui::loadCharacterVertices(colonVertices, sizeof(colonVertices));
 	Gui::characters[26].ranges.push_back({ 0, 4 });
 	Gui::characters[26].ranges.push_back({ 4, 4 });
 	Gui::characters[26].width = 0.14590964590964592f;
@@ -1032,7 +1100,7 @@ void gui::Gui::loadAllCharacters() {
 		-0.431924882629108f, 0.3638583638583639f,
 		0.6901408450704225f, 0.3638583638583639f,
 	};
-	Gui::characters[27].vao = gui::Gui::loadCharacterVertices(semicolonVertices, sizeof(semicolonVertices));
+	Gui::characters[27].allocation = gui::Gui::loadCharacterVertices(semicolonVertices, sizeof(semicolonVertices));
 	Gui::characters[27].ranges.push_back({ 0, 4 });
 	Gui::characters[27].ranges.push_back({ 4, 4 });
 	Gui::characters[27].width = 0.2600732600732601f;
@@ -1048,7 +1116,7 @@ void gui::Gui::loadAllCharacters() {
 		1.0f, 0.2783882783882784f,
 		1.0f, 0.49572649572649574f,
 	};
-	Gui::characters[28].vao = gui::Gui::loadCharacterVertices(lessVertices, sizeof(lessVertices));
+	Gui::characters[28].allocation = gui::Gui::loadCharacterVertices(lessVertices, sizeof(lessVertices));
 	Gui::characters[28].ranges.push_back({ 0, 7 });
 	Gui::characters[28].width = 0.6556776556776557f;
 
@@ -1065,7 +1133,7 @@ void gui::Gui::loadAllCharacters() {
 		1.0f, -0.04517704517704524f,
 		1.0f, 0.1501831501831502f,
 	};
-	Gui::characters[29].vao = gui::Gui::loadCharacterVertices(equalVertices, sizeof(equalVertices));
+	Gui::characters[29].allocation = gui::Gui::loadCharacterVertices(equalVertices, sizeof(equalVertices));
 	Gui::characters[29].ranges.push_back({ 0, 4 });
 	Gui::characters[29].ranges.push_back({ 4, 4 });
 	Gui::characters[29].width = 0.6752136752136753f;
@@ -1081,7 +1149,7 @@ void gui::Gui::loadAllCharacters() {
 		-1.0f, 0.2783882783882784f,
 		-1.0f, 0.49572649572649574f,
 	};
-	Gui::characters[30].vao = gui::Gui::loadCharacterVertices(greaterVertices, sizeof(greaterVertices));
+	Gui::characters[30].allocation = gui::Gui::loadCharacterVertices(greaterVertices, sizeof(greaterVertices));
 	Gui::characters[30].ranges.push_back({ 0, 7 });
 	Gui::characters[30].width = 0.6556776556776557f;
 
@@ -1119,7 +1187,7 @@ void gui::Gui::loadAllCharacters() {
 		-1.0f, 0.7692307692307692f,
 		-1.0f, 0.5201465201465201f,
 	};
-	Gui::characters[31].vao = gui::Gui::loadCharacterVertices(questionVertices, sizeof(questionVertices));
+	Gui::characters[31].allocation = gui::Gui::loadCharacterVertices(questionVertices, sizeof(questionVertices));
 	Gui::characters[31].ranges.push_back({ 0, 4 });
 	Gui::characters[31].ranges.push_back({ 4, 25 });
 	Gui::characters[31].width = 0.4902319902319902f;
@@ -1194,7 +1262,7 @@ void gui::Gui::loadAllCharacters() {
 		0.26197884256378345f, -0.6666666666666667f,
 		0.25700062227753584f, -0.5018315018315018f,
 	};
-	Gui::characters[32].vao = gui::Gui::loadCharacterVertices(atVertices, sizeof(atVertices));
+	Gui::characters[32].allocation = gui::Gui::loadCharacterVertices(atVertices, sizeof(atVertices));
 	Gui::characters[32].ranges.push_back({ 0, 39 });
 	Gui::characters[32].ranges.push_back({ 39, 26 });
 	Gui::characters[32].width = 0.981074481074481f;
@@ -1215,7 +1283,7 @@ void gui::Gui::loadAllCharacters() {
 		0.36057692307692313f, -0.2857142857142858f,
 		0.4487179487179487f, -0.4920634920634921f,
 	};
-	Gui::characters[33].vao = gui::Gui::loadCharacterVertices(aCapVertices, sizeof(aCapVertices));
+	Gui::characters[33].allocation = gui::Gui::loadCharacterVertices(aCapVertices, sizeof(aCapVertices));
 	Gui::characters[33].ranges.push_back({ 0, 7 });
 	Gui::characters[33].ranges.push_back({ 7, 4 });
 	Gui::characters[33].width = 0.7619047619047619f;
@@ -1266,7 +1334,7 @@ void gui::Gui::loadAllCharacters() {
 		0.4475247524752475f, 0.009768009768009733f,
 		0.4475247524752475f, 0.019536019536019578f,
 	};
-	Gui::characters[34].vao = gui::Gui::loadCharacterVertices(bCapVertices, sizeof(bCapVertices));
+	Gui::characters[34].allocation = gui::Gui::loadCharacterVertices(bCapVertices, sizeof(bCapVertices));
 	Gui::characters[34].ranges.push_back({ 0, 42 });
 	Gui::characters[34].width = 0.6166056166056166f;
 
@@ -1310,7 +1378,7 @@ void gui::Gui::loadAllCharacters() {
 		0.9716814159292035f, 0.4053724053724054f,
 		1.0f, 0.4053724053724054f,
 	};
-	Gui::characters[35].vao = gui::Gui::loadCharacterVertices(cCapVertices, sizeof(cCapVertices));
+	Gui::characters[35].allocation = gui::Gui::loadCharacterVertices(cCapVertices, sizeof(cCapVertices));
 	Gui::characters[35].ranges.push_back({ 0, 36 });
 	Gui::characters[35].width = 0.6898656898656899f;
 
@@ -1342,7 +1410,7 @@ void gui::Gui::loadAllCharacters() {
 		-1.0f, -1.0f,
 		-0.6626916524701874f, -0.7924297924297925f,
 	};
-	Gui::characters[36].vao = gui::Gui::loadCharacterVertices(dCapVertices, sizeof(dCapVertices));
+	Gui::characters[36].allocation = gui::Gui::loadCharacterVertices(dCapVertices, sizeof(dCapVertices));
 	Gui::characters[36].ranges.push_back({ 0, 24 });
 	Gui::characters[36].width = 0.7167277167277167f;
 
@@ -1363,7 +1431,7 @@ void gui::Gui::loadAllCharacters() {
 		0.8925886143931256f, 0.10500610500610497f,
 		0.8925886143931256f, -0.10989010989010994f,
 	};
-	Gui::characters[37].vao = gui::Gui::loadCharacterVertices(eCapVertices, sizeof(eCapVertices));
+	Gui::characters[37].allocation = gui::Gui::loadCharacterVertices(eCapVertices, sizeof(eCapVertices));
 	Gui::characters[37].ranges.push_back({ 0, 8 });
 	Gui::characters[37].ranges.push_back({ 8, 4 });
 	Gui::characters[37].width = 0.5683760683760684f;
@@ -1383,7 +1451,7 @@ void gui::Gui::loadAllCharacters() {
 		0.9349046015712683f, 0.09035409035409037f,
 		0.9349046015712683f, -0.12454212454212454f,
 	};
-	Gui::characters[38].vao = gui::Gui::loadCharacterVertices(fCapVertices, sizeof(fCapVertices));
+	Gui::characters[38].allocation = gui::Gui::loadCharacterVertices(fCapVertices, sizeof(fCapVertices));
 	Gui::characters[38].ranges.push_back({ 0, 6 });
 	Gui::characters[38].ranges.push_back({ 6, 4 });
 	Gui::characters[38].width = 0.5439560439560439f;
@@ -1429,7 +1497,7 @@ void gui::Gui::loadAllCharacters() {
 		0.9900249376558603f, 0.40293040293040294f,
 		0.9900249376558603f, 0.6947496947496947f,
 	};
-	Gui::characters[39].vao = gui::Gui::loadCharacterVertices(gCapVertices, sizeof(gCapVertices));
+	Gui::characters[39].allocation = gui::Gui::loadCharacterVertices(gCapVertices, sizeof(gCapVertices));
 	Gui::characters[39].ranges.push_back({ 0, 37 });
 	Gui::characters[39].width = 0.7344322344322345f;
 
@@ -1451,7 +1519,7 @@ void gui::Gui::loadAllCharacters() {
 		1.0f, 0.818070818070818f,
 		1.0f, -1.0f,
 	};
-	Gui::characters[40].vao = gui::Gui::loadCharacterVertices(hCapVertices, sizeof(hCapVertices));
+	Gui::characters[40].allocation = gui::Gui::loadCharacterVertices(hCapVertices, sizeof(hCapVertices));
 	Gui::characters[40].ranges.push_back({ 0, 4 });
 	Gui::characters[40].ranges.push_back({ 4, 4 });
 	Gui::characters[40].ranges.push_back({ 8, 4 });
@@ -1475,7 +1543,7 @@ void gui::Gui::loadAllCharacters() {
 		1.0f, 0.818070818070818f,
 		1.0f, 0.6324786324786325f,
 	};
-	Gui::characters[41].vao = gui::Gui::loadCharacterVertices(iCapVertices, sizeof(iCapVertices));
+	Gui::characters[41].allocation = gui::Gui::loadCharacterVertices(iCapVertices, sizeof(iCapVertices));
 	Gui::characters[41].ranges.push_back({ 0, 4 });
 	Gui::characters[41].ranges.push_back({ 4, 4 });
 	Gui::characters[41].ranges.push_back({ 8, 4 });
@@ -1504,7 +1572,7 @@ void gui::Gui::loadAllCharacters() {
 		-0.45945945945945943f, 0.818070818070818f,
 		-0.45945945945945943f, 0.6251526251526252f,
 	};
-	Gui::characters[42].vao = gui::Gui::loadCharacterVertices(jCapVertices, sizeof(jCapVertices));
+	Gui::characters[42].allocation = gui::Gui::loadCharacterVertices(jCapVertices, sizeof(jCapVertices));
 	Gui::characters[42].ranges.push_back({ 0, 19 });
 	Gui::characters[42].width = 0.42918192918192916f;
 
@@ -1527,7 +1595,7 @@ void gui::Gui::loadAllCharacters() {
 		-0.20184331797235022f, 0.006105006105006083f,
 		1.0f, -1.0f,
 	};
-	Gui::characters[43].vao = gui::Gui::loadCharacterVertices(kCapVertices, sizeof(kCapVertices));
+	Gui::characters[43].allocation = gui::Gui::loadCharacterVertices(kCapVertices, sizeof(kCapVertices));
 	Gui::characters[43].ranges.push_back({ 0, 4 });
 	Gui::characters[43].ranges.push_back({ 4, 5 });
 	Gui::characters[43].ranges.push_back({ 9, 4 });
@@ -1543,7 +1611,7 @@ void gui::Gui::loadAllCharacters() {
 		1.0f, -1.0f,
 		1.0f, -0.7851037851037852f,
 	};
-	Gui::characters[44].vao = gui::Gui::loadCharacterVertices(lCapVertices, sizeof(lCapVertices));
+	Gui::characters[44].allocation = gui::Gui::loadCharacterVertices(lCapVertices, sizeof(lCapVertices));
 	Gui::characters[44].ranges.push_back({ 0, 6 });
 	Gui::characters[44].width = 0.5268620268620269f;
 
@@ -1564,7 +1632,7 @@ void gui::Gui::loadAllCharacters() {
 		0.6896551724137931f, -1.0f,
 		1.0f, -1.0f,
 	};
-	Gui::characters[45].vao = gui::Gui::loadCharacterVertices(mCapVertices, sizeof(mCapVertices));
+	Gui::characters[45].allocation = gui::Gui::loadCharacterVertices(mCapVertices, sizeof(mCapVertices));
 	Gui::characters[45].ranges.push_back({ 0, 13 });
 	Gui::characters[45].width = 0.778998778998779f;
 
@@ -1582,7 +1650,7 @@ void gui::Gui::loadAllCharacters() {
 		0.6525821596244132f, 0.818070818070818f,
 		1.0f, 0.818070818070818f,
 	};
-	Gui::characters[46].vao = gui::Gui::loadCharacterVertices(nCapVertices, sizeof(nCapVertices));
+	Gui::characters[46].allocation = gui::Gui::loadCharacterVertices(nCapVertices, sizeof(nCapVertices));
 	Gui::characters[46].ranges.push_back({ 0, 10 });
 	Gui::characters[46].width = 0.6501831501831502f;
 
@@ -1624,7 +1692,7 @@ void gui::Gui::loadAllCharacters() {
 		-1.0f, -0.09157509157509147f,
 		-0.6871678056188306f, -0.09157509157509147f,
 	};
-	Gui::characters[47].vao = gui::Gui::loadCharacterVertices(oCapVertices, sizeof(oCapVertices));
+	Gui::characters[47].allocation = gui::Gui::loadCharacterVertices(oCapVertices, sizeof(oCapVertices));
 	Gui::characters[47].ranges.push_back({ 0, 34 });
 	Gui::characters[47].width = 0.8040293040293041f;
 
@@ -1656,7 +1724,7 @@ void gui::Gui::loadAllCharacters() {
 		-0.5787234042553191f, -0.3223443223443223f,
 		-0.5787234042553191f, -0.11599511599511603f,
 	};
-	Gui::characters[48].vao = gui::Gui::loadCharacterVertices(pCapVertices, sizeof(pCapVertices));
+	Gui::characters[48].allocation = gui::Gui::loadCharacterVertices(pCapVertices, sizeof(pCapVertices));
 	Gui::characters[48].ranges.push_back({ 0, 24 });
 	Gui::characters[48].width = 0.5738705738705738f;
 
@@ -1712,7 +1780,7 @@ void gui::Gui::loadAllCharacters() {
 		0.06505295007564293f, -1.0366300366300365f,
 		0.28290468986384276f, -0.7814407814407816f,
 	};
-	Gui::characters[49].vao = gui::Gui::loadCharacterVertices(qCapVertices, sizeof(qCapVertices));
+	Gui::characters[49].allocation = gui::Gui::loadCharacterVertices(qCapVertices, sizeof(qCapVertices));
 	Gui::characters[49].ranges.push_back({ 0, 48 });
 	Gui::characters[49].width = 0.8070818070818071f;
 
@@ -1750,7 +1818,7 @@ void gui::Gui::loadAllCharacters() {
 		1.0f, -1.0f,
 		0.554206418039896f, -1.0f,
 	};
-	Gui::characters[50].vao = gui::Gui::loadCharacterVertices(rCapVertices, sizeof(rCapVertices));
+	Gui::characters[50].allocation = gui::Gui::loadCharacterVertices(rCapVertices, sizeof(rCapVertices));
 	Gui::characters[50].ranges.push_back({ 0, 25 });
 	Gui::characters[50].ranges.push_back({ 25, 4 });
 	Gui::characters[50].width = 0.703907203907204f;
@@ -1799,7 +1867,7 @@ void gui::Gui::loadAllCharacters() {
 		0.8854886475814412f, 0.7338217338217339f,
 		0.8854886475814412f, 0.4444444444444444f,
 	};
-	Gui::characters[51].vao = gui::Gui::loadCharacterVertices(sCapVertices, sizeof(sCapVertices));
+	Gui::characters[51].allocation = gui::Gui::loadCharacterVertices(sCapVertices, sizeof(sCapVertices));
 	Gui::characters[51].ranges.push_back({ 0, 40 });
 	Gui::characters[51].width = 0.6184371184371185f;
 
@@ -1816,7 +1884,7 @@ void gui::Gui::loadAllCharacters() {
 		-0.1652754590984975f, -1.0f,
 		0.1652754590984975f, -1.0f,
 	};
-	Gui::characters[52].vao = gui::Gui::loadCharacterVertices(tCapVertices, sizeof(tCapVertices));
+	Gui::characters[52].allocation = gui::Gui::loadCharacterVertices(tCapVertices, sizeof(tCapVertices));
 	Gui::characters[52].ranges.push_back({ 0, 4 });
 	Gui::characters[52].ranges.push_back({ 4, 4 });
 	Gui::characters[52].width = 0.7313797313797313f;
@@ -1847,7 +1915,7 @@ void gui::Gui::loadAllCharacters() {
 		1.0f, 0.818070818070818f,
 		0.6323119777158774f, 0.818070818070818f,
 	};
-	Gui::characters[53].vao = gui::Gui::loadCharacterVertices(uCapVertices, sizeof(uCapVertices));
+	Gui::characters[53].allocation = gui::Gui::loadCharacterVertices(uCapVertices, sizeof(uCapVertices));
 	Gui::characters[53].ranges.push_back({ 0, 22 });
 	Gui::characters[53].width = 0.6575091575091575f;
 
@@ -1862,7 +1930,7 @@ void gui::Gui::loadAllCharacters() {
 		0.6736672051696284f, 0.818070818070818f,
 		1.0f, 0.818070818070818f,
 	};
-	Gui::characters[54].vao = gui::Gui::loadCharacterVertices(vCapVertices, sizeof(vCapVertices));
+	Gui::characters[54].allocation = gui::Gui::loadCharacterVertices(vCapVertices, sizeof(vCapVertices));
 	Gui::characters[54].ranges.push_back({ 0, 7 });
 	Gui::characters[54].width = 0.7557997557997558f;
 
@@ -1883,7 +1951,7 @@ void gui::Gui::loadAllCharacters() {
 		0.7838440111420613f, 0.818070818070818f,
 		1.0f, 0.818070818070818f,
 	};
-	Gui::characters[55].vao = gui::Gui::loadCharacterVertices(wCapVertices, sizeof(wCapVertices));
+	Gui::characters[55].allocation = gui::Gui::loadCharacterVertices(wCapVertices, sizeof(wCapVertices));
 	Gui::characters[55].ranges.push_back({ 0, 13 });
 	Gui::characters[55].width = 1.095848595848596f;
 
@@ -1900,7 +1968,7 @@ void gui::Gui::loadAllCharacters() {
 		0.6317135549872124f, 0.818070818070818f,
 		0.9982949701619779f, 0.818070818070818f,
 	};
-	Gui::characters[56].vao = gui::Gui::loadCharacterVertices(xCapVertices, sizeof(xCapVertices));
+	Gui::characters[56].allocation = gui::Gui::loadCharacterVertices(xCapVertices, sizeof(xCapVertices));
 	Gui::characters[56].ranges.push_back({ 0, 4 });
 	Gui::characters[56].ranges.push_back({ 4, 4 });
 	Gui::characters[56].width = 0.7161172161172161f;
@@ -1921,7 +1989,7 @@ void gui::Gui::loadAllCharacters() {
 		-0.16445182724252494f, -0.2210012210012211f,
 		0.16445182724252483f, -0.19536019536019533f,
 	};
-	Gui::characters[57].vao = gui::Gui::loadCharacterVertices(yCapVertices, sizeof(yCapVertices));
+	Gui::characters[57].allocation = gui::Gui::loadCharacterVertices(yCapVertices, sizeof(yCapVertices));
 	Gui::characters[57].ranges.push_back({ 0, 7 });
 	Gui::characters[57].ranges.push_back({ 7, 4 });
 	Gui::characters[57].width = 0.7350427350427351f;
@@ -1940,7 +2008,7 @@ void gui::Gui::loadAllCharacters() {
 		1.0f, -0.7851037851037852f,
 		1.0f, -1.0f,
 	};
-	Gui::characters[58].vao = gui::Gui::loadCharacterVertices(zCapVertices, sizeof(zCapVertices));
+	Gui::characters[58].allocation = gui::Gui::loadCharacterVertices(zCapVertices, sizeof(zCapVertices));
 	Gui::characters[58].ranges.push_back({ 0, 10 });
 	Gui::characters[58].width = 0.6349206349206349f;
 
@@ -1956,7 +2024,7 @@ void gui::Gui::loadAllCharacters() {
 		1.0f, -1.4786324786324787f,
 		1.0f, -1.3040293040293038f,
 	};
-	Gui::characters[59].vao = gui::Gui::loadCharacterVertices(bracketleftVertices, sizeof(bracketleftVertices));
+	Gui::characters[59].allocation = gui::Gui::loadCharacterVertices(bracketleftVertices, sizeof(bracketleftVertices));
 	Gui::characters[59].ranges.push_back({ 0, 8 });
 	Gui::characters[59].width = 0.31746031746031744f;
 
@@ -1968,7 +2036,7 @@ void gui::Gui::loadAllCharacters() {
 		0.550531914893617f, -1.3956043956043955f,
 		1.0f, -1.3956043956043955f,
 	};
-	Gui::characters[60].vao = gui::Gui::loadCharacterVertices(backslashVertices, sizeof(backslashVertices));
+	Gui::characters[60].allocation = gui::Gui::loadCharacterVertices(backslashVertices, sizeof(backslashVertices));
 	Gui::characters[60].ranges.push_back({ 0, 4 });
 	Gui::characters[60].width = 0.4590964590964591f;
 
@@ -1984,7 +2052,7 @@ void gui::Gui::loadAllCharacters() {
 		-1.0f, -1.4786324786324787f,
 		-1.0f, -1.3040293040293038f,
 	};
-	Gui::characters[61].vao = gui::Gui::loadCharacterVertices(bracketrightVertices, sizeof(bracketrightVertices));
+	Gui::characters[61].allocation = gui::Gui::loadCharacterVertices(bracketrightVertices, sizeof(bracketrightVertices));
 	Gui::characters[61].ranges.push_back({ 0, 8 });
 	Gui::characters[61].width = 0.31746031746031744f;
 
@@ -1999,7 +2067,7 @@ void gui::Gui::loadAllCharacters() {
 		0.6764705882352942f, -0.16483516483516492f,
 		1.0f, -0.16483516483516492f,
 	};
-	Gui::characters[62].vao = gui::Gui::loadCharacterVertices(asciicircumVertices, sizeof(asciicircumVertices));
+	Gui::characters[62].allocation = gui::Gui::loadCharacterVertices(asciicircumVertices, sizeof(asciicircumVertices));
 	Gui::characters[62].ranges.push_back({ 0, 7 });
 	Gui::characters[62].width = 0.7472527472527473f;
 
@@ -2011,7 +2079,7 @@ void gui::Gui::loadAllCharacters() {
 		1.0f, -1.2075702075702077f,
 		1.0f, -1.3663003663003663f,
 	};
-	Gui::characters[63].vao = gui::Gui::loadCharacterVertices(underscoreVertices, sizeof(underscoreVertices));
+	Gui::characters[63].allocation = gui::Gui::loadCharacterVertices(underscoreVertices, sizeof(underscoreVertices));
 	Gui::characters[63].ranges.push_back({ 0, 4 });
 	Gui::characters[63].width = 0.702075702075702f;
 
@@ -2023,7 +2091,7 @@ void gui::Gui::loadAllCharacters() {
 		-1.0f, 1.0463980463980465f,
 		0.15165876777251186f, 1.0463980463980465f,
 	};
-	Gui::characters[64].vao = gui::Gui::loadCharacterVertices(graveVertices, sizeof(graveVertices));
+	Gui::characters[64].allocation = gui::Gui::loadCharacterVertices(graveVertices, sizeof(graveVertices));
 	Gui::characters[64].ranges.push_back({ 0, 4 });
 	Gui::characters[64].width = 0.2576312576312576f;
 
@@ -2078,7 +2146,7 @@ void gui::Gui::loadAllCharacters() {
 		0.5793025871766029f, -0.8547008547008548f,
 		0.5793025871766029f, -0.6642246642246643f,
 	};
-	Gui::characters[65].vao = gui::Gui::loadCharacterVertices(aVertices, sizeof(aVertices));
+	Gui::characters[65].allocation = gui::Gui::loadCharacterVertices(aVertices, sizeof(aVertices));
 	Gui::characters[65].ranges.push_back({ 0, 18 });
 	Gui::characters[65].ranges.push_back({ 18, 1 });
 	Gui::characters[65].ranges.push_back({ 19, 26 });
@@ -2119,7 +2187,7 @@ void gui::Gui::loadAllCharacters() {
 		-1.0f, 0.8998778998778999f,
 		-0.5987193169690501f, 0.8998778998778999f,
 	};
-	Gui::characters[66].vao = gui::Gui::loadCharacterVertices(bVertices, sizeof(bVertices));
+	Gui::characters[66].allocation = gui::Gui::loadCharacterVertices(bVertices, sizeof(bVertices));
 	Gui::characters[66].ranges.push_back({ 0, 31 });
 	Gui::characters[66].width = 0.572039072039072f;
 
@@ -2159,7 +2227,7 @@ void gui::Gui::loadAllCharacters() {
 		0.9741480611045827f, 0.03296703296703296f,
 		1.0f, 0.03296703296703296f,
 	};
-	Gui::characters[67].vao = gui::Gui::loadCharacterVertices(cVertices, sizeof(cVertices));
+	Gui::characters[67].allocation = gui::Gui::loadCharacterVertices(cVertices, sizeof(cVertices));
 	Gui::characters[67].ranges.push_back({ 0, 32 });
 	Gui::characters[67].width = 0.5195360195360196f;
 
@@ -2201,7 +2269,7 @@ void gui::Gui::loadAllCharacters() {
 		0.5987193169690501f, 0.8998778998778999f,
 		1.0f, 0.8998778998778999f,
 	};
-	Gui::characters[68].vao = gui::Gui::loadCharacterVertices(dVertices, sizeof(dVertices));
+	Gui::characters[68].allocation = gui::Gui::loadCharacterVertices(dVertices, sizeof(dVertices));
 	Gui::characters[68].ranges.push_back({ 0, 34 });
 	Gui::characters[68].width = 0.572039072039072f;
 
@@ -2249,7 +2317,7 @@ void gui::Gui::loadAllCharacters() {
 		-0.6041450777202073f, -0.16605616605616613f,
 		-0.6041450777202073f, -0.3418803418803418f,
 	};
-	Gui::characters[69].vao = gui::Gui::loadCharacterVertices(eVertices, sizeof(eVertices));
+	Gui::characters[69].allocation = gui::Gui::loadCharacterVertices(eVertices, sizeof(eVertices));
 	Gui::characters[69].ranges.push_back({ 0, 40 });
 	Gui::characters[69].width = 0.5891330891330891f;
 
@@ -2283,7 +2351,7 @@ void gui::Gui::loadAllCharacters() {
 		0.7841726618705036f, 0.3638583638583639f,
 		0.7841726618705036f, 0.17338217338217343f,
 	};
-	Gui::characters[70].vao = gui::Gui::loadCharacterVertices(fVertices, sizeof(fVertices));
+	Gui::characters[70].allocation = gui::Gui::loadCharacterVertices(fVertices, sizeof(fVertices));
 	Gui::characters[70].ranges.push_back({ 0, 21 });
 	Gui::characters[70].ranges.push_back({ 21, 4 });
 	Gui::characters[70].width = 0.4242979242979243f;
@@ -2336,7 +2404,7 @@ void gui::Gui::loadAllCharacters() {
 		0.5987193169690501f, -0.63003663003663f,
 		0.5987193169690501f, -0.8192918192918193f,
 	};
-	Gui::characters[71].vao = gui::Gui::loadCharacterVertices(gVertices, sizeof(gVertices));
+	Gui::characters[71].allocation = gui::Gui::loadCharacterVertices(gVertices, sizeof(gVertices));
 	Gui::characters[71].ranges.push_back({ 0, 44 });
 	Gui::characters[71].width = 0.572039072039072f;
 
@@ -2365,7 +2433,7 @@ void gui::Gui::loadAllCharacters() {
 		1.0f, -1.0f,
 		0.571753986332574f, -1.0f,
 	};
-	Gui::characters[72].vao = gui::Gui::loadCharacterVertices(hVertices, sizeof(hVertices));
+	Gui::characters[72].allocation = gui::Gui::loadCharacterVertices(hVertices, sizeof(hVertices));
 	Gui::characters[72].ranges.push_back({ 0, 4 });
 	Gui::characters[72].ranges.push_back({ 4, 16 });
 	Gui::characters[72].width = 0.536019536019536f;
@@ -2383,7 +2451,7 @@ void gui::Gui::loadAllCharacters() {
 		-0.8785046728971962f, -1.0f,
 		0.8785046728971964f, -1.0f,
 	};
-	Gui::characters[73].vao = gui::Gui::loadCharacterVertices(iVertices, sizeof(iVertices));
+	Gui::characters[73].allocation = gui::Gui::loadCharacterVertices(iVertices, sizeof(iVertices));
 	Gui::characters[73].ranges.push_back({ 0, 4 });
 	Gui::characters[73].ranges.push_back({ 4, 4 });
 	Gui::characters[73].width = 0.13064713064713065f;
@@ -2416,7 +2484,7 @@ void gui::Gui::loadAllCharacters() {
 		0.19548872180451138f, 0.5921855921855922f,
 		1.0f, 0.5921855921855922f,
 	};
-	Gui::characters[74].vao = gui::Gui::loadCharacterVertices(jVertices, sizeof(jVertices));
+	Gui::characters[74].allocation = gui::Gui::loadCharacterVertices(jVertices, sizeof(jVertices));
 	Gui::characters[74].ranges.push_back({ 0, 19 });
 	Gui::characters[74].ranges.push_back({ 19, 4 });
 	Gui::characters[74].width = 0.3247863247863248f;
@@ -2440,7 +2508,7 @@ void gui::Gui::loadAllCharacters() {
 		-0.12526997840172782f, -0.20634920634920628f,
 		-0.43412526997840173f, -0.3418803418803418f,
 	};
-	Gui::characters[75].vao = gui::Gui::loadCharacterVertices(kVertices, sizeof(kVertices));
+	Gui::characters[75].allocation = gui::Gui::loadCharacterVertices(kVertices, sizeof(kVertices));
 	Gui::characters[75].ranges.push_back({ 0, 4 });
 	Gui::characters[75].ranges.push_back({ 4, 5 });
 	Gui::characters[75].ranges.push_back({ 9, 4 });
@@ -2454,7 +2522,7 @@ void gui::Gui::loadAllCharacters() {
 		-1.0f, -1.0f,
 		1.0f, -1.0f,
 	};
-	Gui::characters[76].vao = gui::Gui::loadCharacterVertices(lVertices, sizeof(lVertices));
+	Gui::characters[76].allocation = gui::Gui::loadCharacterVertices(lVertices, sizeof(lVertices));
 	Gui::characters[76].ranges.push_back({ 0, 4 });
 	Gui::characters[76].width = 0.11477411477411477f;
 
@@ -2501,7 +2569,7 @@ void gui::Gui::loadAllCharacters() {
 		1.0f, -1.0f,
 		0.7417582417582418f, -1.0f,
 	};
-	Gui::characters[77].vao = gui::Gui::loadCharacterVertices(mVertices, sizeof(mVertices));
+	Gui::characters[77].allocation = gui::Gui::loadCharacterVertices(mVertices, sizeof(mVertices));
 	Gui::characters[77].ranges.push_back({ 0, 4 });
 	Gui::characters[77].ranges.push_back({ 4, 17 });
 	Gui::characters[77].ranges.push_back({ 21, 16 });
@@ -2532,7 +2600,7 @@ void gui::Gui::loadAllCharacters() {
 		0.571753986332574f, -1.0f,
 		1.0f, -1.0f,
 	};
-	Gui::characters[78].vao = gui::Gui::loadCharacterVertices(nVertices, sizeof(nVertices));
+	Gui::characters[78].allocation = gui::Gui::loadCharacterVertices(nVertices, sizeof(nVertices));
 	Gui::characters[78].ranges.push_back({ 0, 4 });
 	Gui::characters[78].ranges.push_back({ 4, 16 });
 	Gui::characters[78].width = 0.536019536019536f;
@@ -2575,7 +2643,7 @@ void gui::Gui::loadAllCharacters() {
 		-1.0f, -0.31868131868131866f,
 		-0.6112224448897796f, -0.31868131868131866f,
 	};
-	Gui::characters[79].vao = gui::Gui::loadCharacterVertices(oVertices, sizeof(oVertices));
+	Gui::characters[79].allocation = gui::Gui::loadCharacterVertices(oVertices, sizeof(oVertices));
 	Gui::characters[79].ranges.push_back({ 0, 34 });
 	Gui::characters[79].width = 0.6092796092796092f;
 
@@ -2614,7 +2682,7 @@ void gui::Gui::loadAllCharacters() {
 		-0.5987193169690501f, -0.9316239316239316f,
 		-0.5987193169690501f, -0.7448107448107448f,
 	};
-	Gui::characters[80].vao = gui::Gui::loadCharacterVertices(pVertices, sizeof(pVertices));
+	Gui::characters[80].allocation = gui::Gui::loadCharacterVertices(pVertices, sizeof(pVertices));
 	Gui::characters[80].ranges.push_back({ 0, 4 });
 	Gui::characters[80].ranges.push_back({ 4, 26 });
 	Gui::characters[80].width = 0.572039072039072f;
@@ -2656,7 +2724,7 @@ void gui::Gui::loadAllCharacters() {
 		0.5987193169690501f, -0.8510378510378511f,
 		0.5987193169690501f, -0.6581196581196582f,
 	};
-	Gui::characters[81].vao = gui::Gui::loadCharacterVertices(qVertices, sizeof(qVertices));
+	Gui::characters[81].allocation = gui::Gui::loadCharacterVertices(qVertices, sizeof(qVertices));
 	Gui::characters[81].ranges.push_back({ 0, 6 });
 	Gui::characters[81].ranges.push_back({ 6, 26 });
 	Gui::characters[81].width = 0.572039072039072f;
@@ -2685,7 +2753,7 @@ void gui::Gui::loadAllCharacters() {
 		1.0f, 0.3565323565323565f,
 		1.0f, 0.11721611721611724f,
 	};
-	Gui::characters[82].vao = gui::Gui::loadCharacterVertices(rVertices, sizeof(rVertices));
+	Gui::characters[82].allocation = gui::Gui::loadCharacterVertices(rVertices, sizeof(rVertices));
 	Gui::characters[82].ranges.push_back({ 0, 4 });
 	Gui::characters[82].ranges.push_back({ 4, 15 });
 	Gui::characters[82].width = 0.3614163614163614f;
@@ -2743,7 +2811,7 @@ void gui::Gui::loadAllCharacters() {
 		0.8737623762376239f, 0.05250305250305254f,
 		0.8985148514851484f, 0.05250305250305254f,
 	};
-	Gui::characters[83].vao = gui::Gui::loadCharacterVertices(sVertices, sizeof(sVertices));
+	Gui::characters[83].allocation = gui::Gui::loadCharacterVertices(sVertices, sizeof(sVertices));
 	Gui::characters[83].ranges.push_back({ 0, 49 });
 	Gui::characters[83].width = 0.4932844932844933f;
 
@@ -2773,7 +2841,7 @@ void gui::Gui::loadAllCharacters() {
 		1.0f, 0.3638583638583639f,
 		1.0f, 0.17338217338217343f,
 	};
-	Gui::characters[84].vao = gui::Gui::loadCharacterVertices(tVertices, sizeof(tVertices));
+	Gui::characters[84].allocation = gui::Gui::loadCharacterVertices(tVertices, sizeof(tVertices));
 	Gui::characters[84].ranges.push_back({ 0, 17 });
 	Gui::characters[84].ranges.push_back({ 17, 4 });
 	Gui::characters[84].width = 0.40354090354090355f;
@@ -2802,7 +2870,7 @@ void gui::Gui::loadAllCharacters() {
 		0.571753986332574f, 0.3638583638583639f,
 		1.0f, 0.3638583638583639f,
 	};
-	Gui::characters[85].vao = gui::Gui::loadCharacterVertices(uVertices, sizeof(uVertices));
+	Gui::characters[85].allocation = gui::Gui::loadCharacterVertices(uVertices, sizeof(uVertices));
 	Gui::characters[85].ranges.push_back({ 0, 20 });
 	Gui::characters[85].width = 0.536019536019536f;
 
@@ -2817,7 +2885,7 @@ void gui::Gui::loadAllCharacters() {
 		0.6111111111111112f, 0.3638583638583639f,
 		1.0f, 0.3638583638583639f,
 	};
-	Gui::characters[86].vao = gui::Gui::loadCharacterVertices(vVertices, sizeof(vVertices));
+	Gui::characters[86].allocation = gui::Gui::loadCharacterVertices(vVertices, sizeof(vVertices));
 	Gui::characters[86].ranges.push_back({ 0, 7 });
 	Gui::characters[86].width = 0.6153846153846154f;
 
@@ -2838,7 +2906,7 @@ void gui::Gui::loadAllCharacters() {
 		0.7410958904109588f, 0.3638583638583639f,
 		1.0f, 0.3638583638583639f,
 	};
-	Gui::characters[87].vao = gui::Gui::loadCharacterVertices(wVertices, sizeof(wVertices));
+	Gui::characters[87].allocation = gui::Gui::loadCharacterVertices(wVertices, sizeof(wVertices));
 	Gui::characters[87].ranges.push_back({ 0, 13 });
 	Gui::characters[87].width = 0.8913308913308914f;
 
@@ -2855,7 +2923,7 @@ void gui::Gui::loadAllCharacters() {
 		0.5694164989939638f, 0.3638583638583639f,
 		1.0f, 0.3638583638583639f,
 	};
-	Gui::characters[88].vao = gui::Gui::loadCharacterVertices(xVertices, sizeof(xVertices));
+	Gui::characters[88].allocation = gui::Gui::loadCharacterVertices(xVertices, sizeof(xVertices));
 	Gui::characters[88].ranges.push_back({ 0, 4 });
 	Gui::characters[88].ranges.push_back({ 4, 4 });
 	Gui::characters[88].width = 0.6068376068376068f;
@@ -2872,7 +2940,7 @@ void gui::Gui::loadAllCharacters() {
 		0.6111111111111112f, 0.3638583638583639f,
 		1.0f, 0.3638583638583639f,
 	};
-	Gui::characters[89].vao = gui::Gui::loadCharacterVertices(yVertices, sizeof(yVertices));
+	Gui::characters[89].allocation = gui::Gui::loadCharacterVertices(yVertices, sizeof(yVertices));
 	Gui::characters[89].ranges.push_back({ 0, 8 });
 	Gui::characters[89].width = 0.6153846153846154f;
 
@@ -2890,7 +2958,7 @@ void gui::Gui::loadAllCharacters() {
 		1.0f, -0.8083028083028083f,
 		1.0f, -1.0f,
 	};
-	Gui::characters[90].vao = gui::Gui::loadCharacterVertices(zVertices, sizeof(zVertices));
+	Gui::characters[90].allocation = gui::Gui::loadCharacterVertices(zVertices, sizeof(zVertices));
 	Gui::characters[90].ranges.push_back({ 0, 10 });
 	Gui::characters[90].width = 0.5012210012210012f;
 
@@ -2945,7 +3013,7 @@ void gui::Gui::loadAllCharacters() {
 		1.0f, -1.4786324786324787f,
 		1.0f, -1.31013431013431f,
 	};
-	Gui::characters[91].vao = gui::Gui::loadCharacterVertices(braceleftVertices, sizeof(braceleftVertices));
+	Gui::characters[91].allocation = gui::Gui::loadCharacterVertices(braceleftVertices, sizeof(braceleftVertices));
 	Gui::characters[91].ranges.push_back({ 0, 47 });
 	Gui::characters[91].width = 0.5042735042735043f;
 
@@ -2957,7 +3025,7 @@ void gui::Gui::loadAllCharacters() {
 		-1.0f, -1.4786324786324787f,
 		1.0f, -1.4786324786324787f,
 	};
-	Gui::characters[92].vao = gui::Gui::loadCharacterVertices(barVertices, sizeof(barVertices));
+	Gui::characters[92].allocation = gui::Gui::loadCharacterVertices(barVertices, sizeof(barVertices));
 	Gui::characters[92].ranges.push_back({ 0, 4 });
 	Gui::characters[92].width = 0.10195360195360195f;
 
@@ -3012,7 +3080,7 @@ void gui::Gui::loadAllCharacters() {
 		-1.0f, -1.4786324786324787f,
 		-1.0f, -1.31013431013431f,
 	};
-	Gui::characters[93].vao = gui::Gui::loadCharacterVertices(bracerightVertices, sizeof(bracerightVertices));
+	Gui::characters[93].allocation = gui::Gui::loadCharacterVertices(bracerightVertices, sizeof(bracerightVertices));
 	Gui::characters[93].ranges.push_back({ 0, 47 });
 	Gui::characters[93].width = 0.5042735042735043f;
 
@@ -3054,50 +3122,126 @@ void gui::Gui::loadAllCharacters() {
 		0.7250409165302782f, 0.13186813186813184f,
 		1.0f, 0.13186813186813184f,
 	};
-	Gui::characters[94].vao = gui::Gui::loadCharacterVertices(asciitildeVertices, sizeof(asciitildeVertices));
+	Gui::characters[94].allocation = gui::Gui::loadCharacterVertices(asciitildeVertices, sizeof(asciitildeVertices));
 	Gui::characters[94].ranges.push_back({ 0, 34 });
 	Gui::characters[94].width = 0.746031746031746f;
 }
-unsigned int gui::Gui::loadCharacterVertices(float vertices[], int size) {
-	unsigned int vao;
-	glGenVertexArrays(1, &vao);
-	glBindVertexArray(vao);
-
-	unsigned int vbo;
-	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
-
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-
-	return vao;
+int gui::Gui::loadCharacterVertices(float vertices[], int size) {
+	render::BufferArena* vertexArena = render::BufferArena::getVertexArena();
+	int allocation = vertexArena->allocate(size, CHARACTER_VERTEX_SIZE);
+	vertexArena->upload(allocation, vertices, size);
+	return allocation;
 }
 void gui::Gui::setInitialised(bool initialised) {
 	guiIsInitialised = initialised;
 }
 
 gui::OGLWindow* gui::Gui::mainWindow;
-Shader* gui::Gui::shader;
-unsigned int gui::Gui::quadVAO;
+ShaderVariants* gui::Gui::shaders;
+render::VertexArray gui::Gui::quadVAO;
+render::VertexArray gui::Gui::characterVAO;
+int gui::Gui::quadAllocation = render::BufferArena::INVALID_ALLOCATION;
+std::vector<render::Texture> gui::Gui::textures;
 gui::FocusManager* gui::Gui::focusManager;
 gui::KeyManager* gui::Gui::keyManager;
 gui::MouseManager* gui::Gui::mouseManager;
 gui::ResizeManager* gui::Gui::resizeManager;
+gui::TimerWheel* gui::Gui::timers;
 std::vector<gui::Character> gui::Gui::characters;
+std::map<int, std::unique_ptr<gui::GlyphAtlas>> gui::Gui::glyphAtlases;
 
 // Character
 void gui::Character::draw(glm::mat4 transformationMatrix, glm::vec4 color) {
-	Gui::shader->use();
-	Gui::shader->setBool("hasTexture", false);
-	Gui::shader->setVec4("color", color);
-	Gui::shader->setMat4("transformation", transformationMatrix);
+	Shader* shader = Gui::getShader(false);
+	shader->use();
+	shader->setVec4(COLOR_UNIFORM, color);
+	shader->setMat4(TRANSFORMATION_UNIFORM, transformationMatrix);
 
-	glBindVertexArray(this->vao);
+	Gui::characterVAO.bind();
+	int firstVertex = render::BufferArena::getVertexArena()->getOffset(this->allocation) / CHARACTER_VERTEX_SIZE;
 
 	for (auto it = this->ranges.begin(); it != this->ranges.end(); ++it) {
-		glDrawArrays(GL_TRIANGLE_STRIP, (*it).index, (*it).length);
+		glDrawArrays(GL_TRIANGLE_STRIP, firstVertex + (*it).index, (*it).length);
+	}
+}
+
+// GlyphAtlas
+gui::GlyphAtlas::GlyphAtlas(int fontSize) {
+	this->fontSize = fontSize;
+	this->glyphs = std::vector<Glyph>(CHARACTER_COUNT);
+
+	// Glyphs are placed in rows from the bottom of the texture up
+	int x = 0;
+	int y = 0;
+	for (int i = 0; i < CHARACTER_COUNT; ++i) {
+		int width = (int)std::ceil(Gui::getCharacter((char)(i + CHARACTER_OFFSET)).width * fontSize);
+		if (x > 0 && x + width > GLYPH_ATLAS_WIDTH) {
+			x = 0;
+			y += fontSize + GLYPH_PADDING;
+		}
+		this->glyphs[i] = { x, y, width };
+		x += width + GLYPH_PADDING;
 	}
+
+	this->target.setSampleCount(GLYPH_SAMPLE_COUNT);
+	this->target.resize(GLYPH_ATLAS_WIDTH, y + fontSize);
+	this->drawGlyphs();
+}
+int gui::GlyphAtlas::getFontSize() {
+	return this->fontSize;
+}
+int gui::GlyphAtlas::getGlyphWidth(char c) {
+	return this->getGlyph(c)->width;
+}
+glm::vec4 gui::GlyphAtlas::getTextureRegion(char c) {
+	Glyph* glyph = this->getGlyph(c);
+	float width = (float)this->target.getWidth();
+	float height = (float)this->target.getHeight();
+
+	// Rows of the texture go from bottom to top, so the top of the glyph is its highest row
+	return glm::vec4(
+		glyph->x / width,
+		(glyph->y + this->fontSize) / height,
+		glyph->width / width,
+		-this->fontSize / height);
+}
+unsigned int gui::GlyphAtlas::getTexture() {
+	return this->target.getColorTexture();
+}
+void gui::GlyphAtlas::drawGlyphs() {
+	render::GlState* glState = render::GlState::getInstance();
+	int originalViewport[4];
+	glState->getViewport(originalViewport);
+
+	// Drawn in white, the color is chosen when the text is drawn
+	this->target.bind();
+	glm::vec4 clearColor = glm::vec4(0.0f);
+	glClearBufferfv(GL_COLOR, 0, &clearColor[0]);
+	glState->setEnabled(render::Capability::BLEND, false);
+	glState->setEnabled(render::Capability::MULTISAMPLE, true);
+
+	for (int i = 0; i < CHARACTER_COUNT; ++i) {
+		Glyph* glyph = &this->glyphs[i];
+		if (glyph->width <= 0)
+			continue;
+
+		// Characters fill the whole viewport, the part rounded up on the right is left empty
+		Character character = Gui::getCharacter((char)(i + CHARACTER_OFFSET));
+		float scale = character.width * this->fontSize / glyph->width;
+		glm::mat4 transformationMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(scale - 1.0f, 0.0f, 0.0f));
+		transformationMatrix = glm::scale(transformationMatrix, glm::vec3(scale, 1.0f, 1.0f));
+
+		glState->setViewport(glyph->x, glyph->y, glyph->width, this->fontSize);
+		character.draw(transformationMatrix, glm::vec4(1.0f));
+	}
+
+	this->target.resolve();
+	render::RenderTarget::bindWindow();
+	glState->setEnabled(render::Capability::BLEND, true);
+	glState->setViewport(originalViewport[0], originalViewport[1], originalViewport[2], originalViewport[3]);
+}
+gui::GlyphAtlas::Glyph* gui::GlyphAtlas::getGlyph(char c) {
+	return &this->glyphs[((int) c) - CHARACTER_OFFSET];
 }
 
 // Boundary
@@ -3150,6 +3294,7 @@ void gui::MouseListener::onMouseLeave() {}
 void gui::MouseListener::onMousePress(int button, int mods) {}
 void gui::MouseListener::onMouseRelease(int button, int mods) {}
 void gui::MouseListener::onMouseScroll(double horizontalScroll, double verticalScroll) {}
+void gui::MouseListener::onMouseMove(float mouseX, float mouseY) {}
 
 // FocusManager
 gui::FocusManager::FocusManager() {
@@ -3165,10 +3310,12 @@ void gui::FocusManager::requestFocus(FocusListener* listener) {
 
 // KeyManager
 void gui::KeyManager::characterCallback(GLFWwindow* window, unsigned int codepoint) {
+	Gui::mainWindow->requestRedraw();
 	char c = (char) codepoint;
 	Gui::keyManager->onCharacterPress(c);
 }
 void gui::KeyManager::keyCallback(GLFWwindow* window, int key, int scanCode, int action, int mods) {
+	Gui::mainWindow->requestRedraw();
 	Gui::keyManager->onKeyPress(key, mods, action);
 }
 void gui::KeyManager::registerKeyListener(KeyListener* keyListener) {
@@ -3190,12 +3337,15 @@ void gui::MouseManager::mousePositionCallback(GLFWwindow* window, double xPos, d
 	float newMouseX = 2.0f * (float)xPos / Gui::mainWindow->getWindowWidth() - 1.0f;
 	float newMouseY = 2.0f * (float)yPos / Gui::mainWindow->getWindowHeight() - 1.0f;
 	
+	Gui::mainWindow->requestRedraw();
 	Gui::mouseManager->onMouseMove(newMouseX, -newMouseY);
 }
 void gui::MouseManager::mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
+	Gui::mainWindow->requestRedraw();
 	Gui::mouseManager->onMouseClick(button, action, mods);
 }
 void gui::MouseManager::mouseScrollCallback(GLFWwindow* window, double xOffset, double yOffset) {
+	Gui::mainWindow->requestRedraw();
 	Gui::mouseManager->onMouseScroll(xOffset, yOffset);
 }
 
@@ -3219,6 +3369,9 @@ void gui::MouseManager::onMouseMove(float newMouseX, float newMouseY) {
 				listener->onMouseLeave();
 			}
 		}
+
+		if (currentlyHoveres)
+			listener->onMouseMove(newMouseX, newMouseY);
 	}
 
 	this->mouseX = newMouseX;
@@ -3250,6 +3403,10 @@ float gui::MouseManager::getMouseY() {
 // ResizeManager
 void gui::ResizeManager::resizeCallback(GLFWwindow* glfwWindow, int width, int height) {
 	Gui::mainWindow->updateWindowSize(width, height);
+	Gui::mainWindow->requestRedraw();
+}
+void gui::ResizeManager::refreshCallback(GLFWwindow* glfwWindow) {
+	Gui::mainWindow->requestRedraw();
 }
 
 // BorderLayout
@@ -3349,21 +3506,20 @@ gui::Panel::Panel() {
 void gui::Panel::draw() {
 	if (this->opaque) {
 
-		Gui::shader->use();
-		Gui::shader->setMat4("transformation", this->transformationMatrix);
-		Gui::shader->setBool("hasTexture", this->hasTexture);
-		Gui::shader->setBool("isTextureColored", false);
+		Shader* shader = Gui::getShader(this->hasTexture);
+		shader->use();
+		shader->setMat4(TRANSFORMATION_UNIFORM, this->transformationMatrix);
 
 		if (this->hasTexture) {
 			// Use texture
-			glBindTexture(GL_TEXTURE_2D, this->textureID);
+			render::GlState::getInstance()->bindTexture(0, GL_TEXTURE_2D, this->textureID);
 		} else {
 			// Use color
-			Gui::shader->setVec4("color", this->backgroundColor);
+			shader->setVec4(COLOR_UNIFORM, this->backgroundColor);
 		}
 
-		glBindVertexArray(Gui::quadVAO);
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+		Gui::quadVAO.bind();
+		glDrawArrays(GL_TRIANGLE_FAN, Gui::getQuadFirstVertex(), 4);
 	}
 
 	// Draw children
@@ -3416,10 +3572,18 @@ void gui::TextLine::drawCharacters() {
 	float screenLeft = this->screenTextLeft;
 	float screenTop = this->screenTextTop;
 
-	float charScreenHeight = ((float) this->fontSize / (float) windowHeight) * 2.0f;
-	float screenBottom = screenTop - charScreenHeight;
+	GlyphAtlas* atlas = Gui::getGlyphAtlas(this->fontSize);
+	Shader* shader = Gui::getGlyphShader();
+	shader->use();
+	shader->setVec4(COLOR_UNIFORM, this->color);
+	render::GlState::getInstance()->bindTexture(0, GL_TEXTURE_2D, atlas->getTexture());
+	Gui::quadVAO.bind();
+
+	// Glyphs start on whole pixels, so every pixel of the atlas lands on exactly one pixel of the window
+	float pixelTop = std::round((screenTop + 1.0f) / 2.0f * windowHeight);
+	float glyphTop = pixelTop / windowHeight * 2.0f - 1.0f;
+	float glyphBottom = (pixelTop - this->fontSize) / windowHeight * 2.0f - 1.0f;
 
-	glEnable(GL_MULTISAMPLE);
 	for (char& cchar : this->text) {
 		gui::Character c = Gui::getCharacter(cchar);
 
@@ -3428,16 +3592,20 @@ void gui::TextLine::drawCharacters() {
 		float charScreenWidth = ((float)charPixelWidth / (float)windowWidth) * 2.0f;
 
 		float screenRight = screenLeft + charScreenWidth;
-		Boundary b = {screenTop, screenRight, screenBottom, screenLeft};
-		glm::mat4 transformationMatrix = Gui::getTransformationMatrix(b);
 
-		c.draw(transformationMatrix, this->color);
+		float pixelLeft = std::round((screenLeft + 1.0f) / 2.0f * windowWidth);
+		float glyphLeft = pixelLeft / windowWidth * 2.0f - 1.0f;
+		float glyphRight = (pixelLeft + atlas->getGlyphWidth(cchar)) / windowWidth * 2.0f - 1.0f;
+		Boundary b = {glyphTop, glyphRight, glyphBottom, glyphLeft};
+
+		shader->setMat4(TRANSFORMATION_UNIFORM, Gui::getTransformationMatrix(b));
+		shader->setVec4(TEXTURE_REGION_UNIFORM, atlas->getTextureRegion(cchar));
+		glDrawArrays(GL_TRIANGLE_FAN, Gui::getQuadFirstVertex(), 4);
 
 		float charPixelDistance = this->charDistance * this->fontSize;
 		float charScreenDistance = ((float)charPixelDistance / (float)windowWidth) * 2.0f;
 		screenLeft = screenRight + charScreenDistance;
 	}
-	glDisable(GL_MULTISAMPLE);
 }
 void gui::TextLine::setColor(glm::vec4 color) {
 	this->color = color;
@@ -3510,14 +3678,12 @@ void gui::TextLine::drawInsertLine(int position) {
 	Boundary barBoundary = { screenTop, screenRight, screenBottom, screenLeft };
 	glm::mat4 mat = Gui::getTransformationMatrix(barBoundary);
 
-	Gui::shader->use();
-	Gui::shader->setBool("hasTexture", false);
-	Gui::shader->setVec4("color", this->getColor());
-	Gui::shader->setMat4("transformation", mat);
-	glBindVertexArray(Gui::quadVAO);
-	glEnable(GL_MULTISAMPLE);
-	glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
-	glDisable(GL_MULTISAMPLE);
+	Shader* shader = Gui::getShader(false);
+	shader->use();
+	shader->setVec4(COLOR_UNIFORM, this->getColor());
+	shader->setMat4(TRANSFORMATION_UNIFORM, mat);
+	Gui::quadVAO.bind();
+	glDrawArrays(GL_TRIANGLE_FAN, Gui::getQuadFirstVertex(), 4);
 }
 float gui::TextLine::getCharDistance() {
 	return this->charDistance;
@@ -3541,16 +3707,16 @@ void gui::Label::draw() {
 
 	// Draw background
 	if (this->opaque) {
-		Gui::shader->use();
-		Gui::shader->setMat4("transformation", this->transformationMatrix);
-		Gui::shader->setBool("hasTexture", this->usesTexture);
+		Shader* shader = Gui::getShader(this->usesTexture);
+		shader->use();
+		shader->setMat4(TRANSFORMATION_UNIFORM, this->transformationMatrix);
 		if (this->usesTexture)
-			glBindTexture(GL_TEXTURE_2D, this->backgroundImage);
+			render::GlState::getInstance()->bindTexture(0, GL_TEXTURE_2D, this->backgroundImage);
 		else
-			Gui::shader->setVec4("color", this->backgroundColor);
+			shader->setVec4(COLOR_UNIFORM, this->backgroundColor);
 
-		glBindVertexArray(Gui::quadVAO);
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+		Gui::quadVAO.bind();
+		glDrawArrays(GL_TRIANGLE_FAN, Gui::getQuadFirstVertex(), 4);
 	}
 
 	// Draw text
@@ -3596,7 +3762,8 @@ void gui::Label::setBackgroundImage(unsigned int image) {
 // TextInput
 gui::TextInput::TextInput() : gui::TextLine("") {
 	this->insertPosition = 0;
-	this->previousInsertUpdate = 0.0;
+	this->isInsertLineShown = false;
+	this->insertLineTimer = TimerWheel::INVALID_TIMER;
 	this->characterLimit = 8;
 
 	this->isFocused = false;
@@ -3619,31 +3786,31 @@ gui::TextInput::TextInput() : gui::TextLine("") {
 	Gui::mouseManager->registerMouseListener(this);
 }
 void gui::TextInput::draw() {
-	Gui::shader->use();
-	glBindVertexArray(Gui::quadVAO);
+	Shader* shader = Gui::getShader(this->hasBackgroundImage);
+	shader->use();
+	Gui::quadVAO.bind();
 
-	Gui::shader->setMat4("transformation", this->transformationMatrix);
-	Gui::shader->setBool("hasTexture", this->hasBackgroundImage);
+	shader->setMat4(TRANSFORMATION_UNIFORM, this->transformationMatrix);
 
 	if (this->hasBackgroundImage) {
 		// Draw image as background
 		if (this->isFocused)
-			glBindTexture(GL_TEXTURE_2D, this->backgroundImageFocused);
+			render::GlState::getInstance()->bindTexture(0, GL_TEXTURE_2D, this->backgroundImageFocused);
 		else if (this->isHovered)
-			glBindTexture(GL_TEXTURE_2D, this->backgroundImageHovered);
+			render::GlState::getInstance()->bindTexture(0, GL_TEXTURE_2D, this->backgroundImageHovered);
 		else
-			glBindTexture(GL_TEXTURE_2D, this->backgroundImageDefault);
+			render::GlState::getInstance()->bindTexture(0, GL_TEXTURE_2D, this->backgroundImageDefault);
 	} else {
 		// Draw background with single color
 		if (this->isFocused)
-			Gui::shader->setVec4("color", this->backgroundColorFocused);
+			shader->setVec4(COLOR_UNIFORM, this->backgroundColorFocused);
 		else if (this->isHovered)
-			Gui::shader->setVec4("color", this->backgroundColorHovered);
+			shader->setVec4(COLOR_UNIFORM, this->backgroundColorHovered);
 		else
-			Gui::shader->setVec4("color", this->backgroundColorDefault);
+			shader->setVec4(COLOR_UNIFORM, this->backgroundColorDefault);
 	}
 
-	glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+	glDrawArrays(GL_TRIANGLE_FAN, Gui::getQuadFirstVertex(), 4);
 
 	this->drawCharacters();
 
@@ -3670,10 +3837,12 @@ void gui::TextInput::updateTextPosition() {
 }
 void gui::TextInput::onFocus() {
 	this->isFocused = true;
+	this->restartInsertLineBlinking();
 	std::cout << "Focused" << std::endl;
 }
 void gui::TextInput::onDefocus() {
 	this->isFocused = false;
+	this->restartInsertLineBlinking();
 	std::cout << "Defocused" << std::endl;
 }
 void gui::TextInput::onMouseEnter() {
@@ -3778,11 +3947,24 @@ void gui::TextInput::moveInsertPosition(int jumpSize) {
 	this->setInsertPosition(this->insertPosition + jumpSize);
 }
 void gui::TextInput::onInsertPositionUpdate() {
-	this->previousInsertUpdate = glfwGetTime();
+	this->restartInsertLineBlinking();
 }
 bool gui::TextInput::shouldInsertLineShow() {
-	double time = glfwGetTime() - this->previousInsertUpdate;
-	return this->isFocused && std::cos(time * 6.0f) > 0;
+	return this->isFocused && this->isInsertLineShown;
+}
+void gui::TextInput::restartInsertLineBlinking() {
+	Gui::timers->cancel(this->insertLineTimer);
+	this->insertLineTimer = TimerWheel::INVALID_TIMER;
+	this->isInsertLineShown = this->isFocused;
+
+	if (this->isFocused)
+		this->insertLineTimer = Gui::timers->schedule(glfwGetTime() + INSERT_LINE_BLINK_INTERVAL, [this] { this->toggleInsertLine(); });
+	Gui::mainWindow->requestRedraw();
+}
+void gui::TextInput::toggleInsertLine() {
+	this->isInsertLineShown = !this->isInsertLineShown;
+	this->insertLineTimer = Gui::timers->schedule(glfwGetTime() + INSERT_LINE_BLINK_INTERVAL, [this] { this->toggleInsertLine(); });
+	Gui::mainWindow->requestRedraw();
 }
 void gui::TextInput::setBackgroundImage(unsigned int defaultTexture, unsigned int hoverTexture, unsigned int focusTexture) {
 	this->backgroundImageDefault = defaultTexture;
@@ -3797,6 +3979,7 @@ gui::DoubleInput::DoubleInput() {
 	this->value = 0.0;
 	this->maxValue = 999.999;
 	this->minValue = -999.999;
+	this->valueListener = nullptr;
 }
 void gui::DoubleInput::onCharacterPress(char c) {
 	if (!this->isFocused)
@@ -3874,7 +4057,7 @@ void gui::DoubleInput::updateValueFromText() {
 	std::string correspondingText = gui::DoubleInput::doubleToString(valueWithinBounds);
 	
 	this->setText(correspondingText);
-	this->value = valueWithinBounds;
+	this->changeValue(valueWithinBounds);
 }
 void gui::DoubleInput::updateTextFromValue() {
 	std::string textFromValue = gui::DoubleInput::doubleToString(this->value);
@@ -3885,17 +4068,37 @@ void gui::DoubleInput::increase(double addition) {
 
 	double newValue = this->value + addition;
 	double valueWithinBounds = this->getValueWithinBounds(newValue);
-	this->value = valueWithinBounds;
+	this->changeValue(valueWithinBounds);
 
 	this->updateTextFromValue();
 	this->setInsertPosition((int)this->text.length());
 }
+double gui::DoubleInput::getValue() {
+	return this->value;
+}
+void gui::DoubleInput::setValue(double value) {
+	// Does not notify the listener, so it can be used to show values set elsewhere
+	this->value = this->getValueWithinBounds(value);
+	this->updateTextFromValue();
+}
+void gui::DoubleInput::setValueListener(ValueListener* listener) {
+	this->valueListener = listener;
+}
+void gui::DoubleInput::changeValue(double newValue) {
+	if (newValue == this->value)
+		return;
+
+	this->value = newValue;
+	if (this->valueListener != nullptr)
+		this->valueListener->onValueChange(newValue);
+}
 void gui::DoubleInput::onFocus() {
 	this->isFocused = true;
 	this->setInsertPosition((int)this->text.length());
 }
 void gui::DoubleInput::onDefocus() {
 	this->isFocused = false;
+	this->restartInsertLineBlinking();
 	this->updateValueFromText();
 }
 double gui::DoubleInput::getValueWithinBounds(double value) {
@@ -3995,23 +4198,23 @@ gui::Button::Button(unsigned int texture, unsigned int textureHover, unsigned in
 	Gui::mouseManager->registerMouseListener(this);
 }
 void gui::Button::draw() {
-	Gui::shader->use();
-	Gui::shader->setMat4("transformation", this->transformationMatrix);
-	Gui::shader->setBool("hasTexture", true);
+	Shader* shader = Gui::getShader(true);
+	shader->use();
+	shader->setMat4(TRANSFORMATION_UNIFORM, this->transformationMatrix);
 
 	if (this->isPressed) {
 		// Draw pressed button
-		glBindTexture(GL_TEXTURE_2D, this->texturePress);
+		render::GlState::getInstance()->bindTexture(0, GL_TEXTURE_2D, this->texturePress);
 	} else if (this->isHovered) {
 		// Draw hovered button
-		glBindTexture(GL_TEXTURE_2D, this->textureHover);
+		render::GlState::getInstance()->bindTexture(0, GL_TEXTURE_2D, this->textureHover);
 	} else {
 		// Draw normal button
-		glBindTexture(GL_TEXTURE_2D, this->texture);
+		render::GlState::getInstance()->bindTexture(0, GL_TEXTURE_2D, this->texture);
 	}
 
-	glBindVertexArray(Gui::quadVAO);
-	glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+	Gui::quadVAO.bind();
+	glDrawArrays(GL_TRIANGLE_FAN, Gui::getQuadFirstVertex(), 4);
 }
 void gui::Button::updateBoundary(Boundary boundary) {
 	this->boundary = boundary;
@@ -4099,19 +4302,43 @@ gui::OGLWindow::OGLWindow(int windowWidth, int windowHeight) : Panel() {
 	glfwSetCharCallback(glfwWindow, &gui::KeyManager::characterCallback);
 	// Resize Callback
 	glfwSetFramebufferSizeCallback(glfwWindow, &gui::ResizeManager::resizeCallback);
+	glfwSetWindowRefreshCallback(glfwWindow, &gui::ResizeManager::refreshCallback);
 
 	this->windowWidth = windowWidth;
 	this->windowHeight = windowHeight;
 	this->boundary = screenBoundary;
+
+	// The first frame is always drawn
+	this->isRedrawRequested = true;
+	this->redrawTimer = TimerWheel::INVALID_TIMER;
+	this->redrawTime = NO_REDRAW_TIME;
+	this->lastFrameTime = 0.0;
+	this->frameCaps[(int)WindowState::FOREGROUND] = NO_FRAME_CAP;
+	this->frameCaps[(int)WindowState::BACKGROUND] = DEFAULT_BACKGROUND_FRAME_CAP;
+	this->frameCaps[(int)WindowState::MINIMIZED] = DEFAULT_MINIMIZED_FRAME_CAP;
+
+	// Decoded textures still have to be uploaded
+	render::TextureLoader::getInstance()->setDecodedCallback([this] {
+		this->requestRedraw();
+	});
 }
 void gui::OGLWindow::draw() {
+	// Requests made while drawing are for the next frame
+	this->isRedrawRequested = false;
+	this->lastFrameTime = glfwGetTime();
+
 	//glEnable(GL_DEPTH_TEST);
 
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	// Allow transparency
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	render::GlState::getInstance()->setEnabled(render::Capability::BLEND, true);
+	render::GlState::getInstance()->setBlendFunction(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	// Upload textures that finished decoding since the previous frame
+	render::TextureLoader::getInstance()->processLoadedImages();
+	if (render::TextureLoader::getInstance()->hasLoadedImages())
+		this->requestRedraw();
 
 	for (auto it = this->children.begin(); it != this->children.end(); ++it) {
 		(*it)->draw();
@@ -4119,7 +4346,58 @@ void gui::OGLWindow::draw() {
 
 	//glEnable(GL_DEPTH_TEST);
 	glfwSwapBuffers(this->glfwWindow);
-	glfwPollEvents();
+
+	// Objects released during this frame are no longer in use
+	render::GpuResource::collectGarbage();
+
+	// Tasks added while running wait for the frame after
+	std::vector<std::function<void()>> tasks;
+	tasks.swap(this->afterFrameTasks);
+	for (std::function<void()>& task : tasks) {
+		task();
+	}
+}
+bool gui::OGLWindow::waitForRedraw() {
+	while (!this->shoudClose()) {
+		// Timers that are due request the frames they need
+		double now = glfwGetTime();
+		Gui::timers->advance(now);
+
+		// A cap only delays requested frames, it never adds any
+		double frameCap = this->frameCaps[(int)this->getWindowState()];
+		double nextFrameTime = frameCap > NO_FRAME_CAP ? this->lastFrameTime + 1.0 / frameCap : now;
+		if (this->isRedrawRequested && now >= nextFrameTime)
+			return true;
+
+		// Callbacks of the events handled here request the next frame
+		double wakeTime = this->isRedrawRequested ? nextFrameTime : Gui::timers->getNextDeadline();
+		if (wakeTime == NO_REDRAW_TIME)
+			glfwWaitEvents();
+		else if (wakeTime > now)
+			glfwWaitEventsTimeout(wakeTime - now);
+		else
+			glfwPollEvents();
+	}
+	return false;
+}
+void gui::OGLWindow::requestRedraw() {
+	this->isRedrawRequested = true;
+	glfwPostEmptyEvent();
+}
+void gui::OGLWindow::requestRedrawAt(double time) {
+	if (time >= this->redrawTime)
+		return;
+
+	Gui::timers->cancel(this->redrawTimer);
+	this->redrawTime = time;
+	this->redrawTimer = Gui::timers->schedule(time, [this] {
+		this->redrawTimer = TimerWheel::INVALID_TIMER;
+		this->redrawTime = NO_REDRAW_TIME;
+		this->requestRedraw();
+	});
+}
+void gui::OGLWindow::setFrameCap(WindowState state, double framesPerSecond) {
+	this->frameCaps[(int)state] = framesPerSecond;
 }
 bool gui::OGLWindow::shoudClose() {
 	return glfwWindowShouldClose(this->glfwWindow);
@@ -4134,17 +4412,28 @@ void gui::OGLWindow::setTitle(std::string title) {
 	glfwSetWindowTitle(this->glfwWindow, title.c_str());
 }
 void gui::OGLWindow::updateWindowSize(int width, int height) {
-	glViewport(0, 0, width, height);
+	render::GlState::getInstance()->setViewport(0, 0, width, height);
 	this->windowWidth = width;
 	this->windowHeight = height;
 	this->updateBoundary(screenBoundary);
 }
+void gui::OGLWindow::runAfterFrame(std::function<void()> task) {
+	this->afterFrameTasks.push_back(task);
+	this->requestRedraw();
+}
 int gui::OGLWindow::getWindowWidth() {
 	return this->windowWidth;
 }
 int gui::OGLWindow::getWindowHeight() {
 	return this->windowHeight;
 }
+gui::OGLWindow::WindowState gui::OGLWindow::getWindowState() {
+	if (glfwGetWindowAttrib(this->glfwWindow, GLFW_ICONIFIED))
+		return WindowState::MINIMIZED;
+	if (!glfwGetWindowAttrib(this->glfwWindow, GLFW_FOCUSED))
+		return WindowState::BACKGROUND;
+	return WindowState::FOREGROUND;
+}
 
 // Exceptions
 NotInitializedException::NotInitializedException() : std::runtime_error("Not yet initialized") {};
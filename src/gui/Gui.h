@@ -1,10 +1,21 @@
 #pragma once
 
 #include <vector>
+#include <map>
+#include <memory>
 #include <string>
 #include <stdexcept>
+#include <functional>
+#include <atomic>
 
 #include "../import/Shader.h"
+#include "../import/ShaderVariants.h"
+#include "../render/GpuResource.h"
+#include "../render/BufferArena.h"
+#include "../render/TextureLoader.h"
+#include "../render/GlState.h"
+#include "../render/RenderTarget.h"
+#include "TimerWheel.h"
 
 namespace gui {
 
@@ -47,6 +58,8 @@ namespace gui {
 			virtual void onMousePress(int button, int mods);
 			virtual void onMouseRelease(int button, int mods);
 			virtual void onMouseScroll(double horizontalScroll, double verticalScroll);
+			// Every movement of the mouse within the boundary
+			virtual void onMouseMove(float mouseX, float mouseY);
 			
 			virtual Boundary getBoundary() = 0;
 	};
@@ -184,6 +197,11 @@ namespace gui {
 			virtual void increase(double increment) = 0;
 	};
 
+	class ValueListener {
+		public:
+			virtual void onValueChange(double value) = 0;
+	};
+
 	class Button : public Element, public MouseListener {
 		public:
 			Button(unsigned int texture, unsigned int textureHover, unsigned int texturePress);
@@ -255,9 +273,12 @@ namespace gui {
 			bool isHovered;
 
 			void moveInsertPosition(int jumpSize);
+			// Shows the insert line and restarts blinking, or stops it without focus
+			void restartInsertLineBlinking();
 		private:
 			int insertPosition;
-			double previousInsertUpdate;
+			bool isInsertLineShown;
+			int insertLineTimer;		// Toggles the insert line while focused
 			int characterLimit;
 
 			int textOffsetLeft;
@@ -277,6 +298,7 @@ namespace gui {
 
 			void onInsertPositionUpdate();
 			bool shouldInsertLineShow();
+			void toggleInsertLine();
 	};
 
 	class DoubleInput : public TextInput, public IncrementListener {
@@ -293,10 +315,17 @@ namespace gui {
 			void updateValueFromText();
 			void updateTextFromValue();
 			void increase(double addition) override;
+
+			double getValue();
+			void setValue(double value);
+			void setValueListener(ValueListener* listener);
 		private:
 			double value;
 			double maxValue;
 			double minValue;
+			ValueListener* valueListener;
+
+			void changeValue(double newValue);
 
 			double getValueWithinBounds(double value);
 
@@ -313,12 +342,34 @@ namespace gui {
 			static const char roundMaxChar = '9';
 	};
 
+	// Frame caps in frames per second, without a cap frames wait for the monitor only
+	const double NO_FRAME_CAP = 0.0;
+
 	class OGLWindow : public gui::Panel {
+		/*
+			Only draws a frame when something asked for one, like input, a timer or work finishing in the background.
+			In between the main loop sleeps in waitForRedraw, without using the CPU or the GPU.
+		*/
 		public:
+			enum class WindowState : int {
+				FOREGROUND = 0,
+				BACKGROUND = 1,		// Visible, but another window has focus
+				MINIMIZED = 2
+			};
+
 			OGLWindow(int windowWidth, int windowHeight);
 
 			void draw() override;
 
+			// Handles events until a frame is due, false if the window should close instead
+			bool waitForRedraw();
+			// Safe to call from any thread, wakes up the main loop
+			void requestRedraw();
+			// Redraws once glfwGetTime reaches the given time, only the earliest of these is kept
+			void requestRedrawAt(double time);
+			// Limits how often requested frames are drawn while the window is in a state
+			void setFrameCap(WindowState state, double framesPerSecond);
+
 			bool shoudClose();
 			void setMinimalWindowSize(int width, int height);
 			void setBackgroundColor(glm::vec4 color);
@@ -328,10 +379,21 @@ namespace gui {
 			int getWindowHeight();
 
 			void updateWindowSize(int width, int height);
+			// Runs once after the next frame is shown, for work that shouldn't delay it
+			void runAfterFrame(std::function<void()> task);
 			GLFWwindow* glfwWindow;
 		private:
 			int windowWidth;
 			int windowHeight;
+			std::vector<std::function<void()>> afterFrameTasks;
+
+			std::atomic<bool> isRedrawRequested;
+			int redrawTimer;
+			double redrawTime;		// Infinity if there is no timed redraw
+			double lastFrameTime;
+			double frameCaps[3];	// By WindowState
+
+			WindowState getWindowState();
 	};
 
 	class KeyManager {
@@ -379,16 +441,49 @@ namespace gui {
 	class ResizeManager {
 		public:
 			static void resizeCallback(GLFWwindow* glfwWindow, int width, int height);
+			// The window was uncovered or restored and has to be drawn again
+			static void refreshCallback(GLFWwindow* glfwWindow);
 	};
 
 	struct Character { // TODO: Create an actual font class
-		unsigned int vao = 0;
+		int allocation = render::BufferArena::INVALID_ALLOCATION;	// Vertices in the shared vertex arena
 		std::vector<Range> ranges;
 		float width = 0.0f;
 
 		void draw(glm::mat4 transformationMatrix, glm::vec4 color);
 	};
 
+	class GlyphAtlas {
+		/*
+			Every character drawn once at one font size, multisampled so its edges are smooth.
+			Text is drawn from here as a textured quad per character, so the window itself doesn't have to be multisampled.
+			Glyphs are as wide as the character rounded up to whole pixels, with the character on their left.
+		*/
+		public:
+			// Has to be created while the gui is drawn, the state the gui relies on is restored afterwards
+			GlyphAtlas(int fontSize);
+
+			int getFontSize();
+			int getGlyphWidth(char c);
+			// Offset and size of the glyph in texture coordinates, from its top left corner
+			glm::vec4 getTextureRegion(char c);
+			unsigned int getTexture();
+
+		private:
+			struct Glyph {
+				int x;
+				int y;
+				int width;
+			};
+
+			int fontSize;
+			std::vector<Glyph> glyphs;
+			render::RenderTarget target;
+
+			void drawGlyphs();
+			Glyph* getGlyph(char c);
+	};
+
 	class Gui {
 		/*
 			Requires GLFW to be set up
@@ -398,26 +493,41 @@ namespace gui {
 
 			static OGLWindow* mainWindow;
 
-			static Shader* shader;
-			static unsigned int quadVAO;
+			static ShaderVariants* shaders;
+			static render::VertexArray quadVAO;
+			static render::VertexArray characterVAO;
 
 			static FocusManager* focusManager;
 			static KeyManager* keyManager;
 			static MouseManager* mouseManager;
 			static ResizeManager* resizeManager;
+			// Deadlines of widgets and animations, the main loop sleeps until the earliest one
+			static TimerWheel* timers;
 
 			static bool isInitialised();
 			static glm::mat4 getTransformationMatrix(Boundary boundary);
+			// Textured shaders sample texture1, the others fill with color
+			static Shader* getShader(bool isTextured);
+			// Draws regions of a glyph atlas in the color
+			static Shader* getGlyphShader();
+			// Created the first time text of the size is drawn
+			static GlyphAtlas* getGlyphAtlas(int fontSize);
 			static unsigned int loadTexture(std::string pathToFile);
 			static Character getCharacter(char c);
+			static int getQuadFirstVertex();
 
 		private:
 			static std::vector<Character> characters;
+			static std::map<int, std::unique_ptr<GlyphAtlas>> glyphAtlases;
+			static int quadAllocation;
+
+			// Owner of the textures that are handed out by name
+			static std::vector<render::Texture> textures;
 
 			static void loadQuadVAO();
 			static void initialiseGLFW();
 			static void loadAllCharacters();
-			static unsigned int loadCharacterVertices(float vertices[], int size);
+			static int loadCharacterVertices(float vertices[], int size);
 			static void setInitialised(bool initialised);
 	};
 }
@@ -0,0 +1,165 @@
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "TimerWheel.h"
+
+// Length of a slot on the lowest level in seconds
+static const double TICK_DURATION = 0.001;
+
+// TimerWheel
+gui::TimerWheel::TimerWheel() {
+	this->currentTick = 0;
+	this->nextID = 0;
+}
+int gui::TimerWheel::schedule(double time, std::function<void()> callback) {
+	Timer timer;
+	timer.id = this->nextID++;
+	timer.tick = TimerWheel::toTick(time);
+	timer.callback = callback;
+
+	int id = timer.id;
+	this->activeTimers[id] = timer.tick;
+	this->place(std::move(timer));
+	return id;
+}
+void gui::TimerWheel::cancel(int timer) {
+	this->activeTimers.erase(timer);
+}
+void gui::TimerWheel::advance(double time) {
+	long long targetTick = (long long)std::floor(time / TICK_DURATION);
+
+	std::vector<Timer> due;
+	due.swap(this->overdueTimers);
+	if (targetTick <= this->currentTick) {
+		// Still in the same tick, only overdue timers can run
+	} else if (this->activeTimers.empty()) {
+		// Nothing to move along, but the slots may still hold cancelled timers
+		this->jumpTo(targetTick, &due);
+	} else if (targetTick - this->currentTick > SLOT_COUNT) {
+		// After sleeping for long, sorting everything out again is cheaper than turning the wheel tick by tick
+		this->jumpTo(targetTick, &due);
+	} else {
+		while (this->currentTick < targetTick) {
+			this->currentTick++;
+			this->cascade(1);
+			this->collectDue(&this->slots[0][this->currentTick & (SLOT_COUNT - 1)], &due);
+		}
+	}
+
+	// Callbacks may schedule or cancel timers, so they run after the wheel is consistent again
+	for (Timer& timer : due) {
+		if (this->activeTimers.erase(timer.id) > 0)
+			timer.callback();
+	}
+}
+double gui::TimerWheel::getNextDeadline() {
+	if (this->activeTimers.empty())
+		return std::numeric_limits<double>::infinity();
+
+	// Slots of a level are in time order starting after the current one, so only the first filled slot of each level counts
+	long long earliestTick = std::numeric_limits<long long>::max();
+	for (Timer& timer : this->overdueTimers) {
+		if (this->activeTimers.count(timer.id) > 0)
+			earliestTick = std::min(earliestTick, timer.tick);
+	}
+	for (int level = 0; level < LEVEL_COUNT; ++level) {
+		int shift = level * SLOT_BITS;
+		int currentSlot = (int)((this->currentTick >> shift) & (SLOT_COUNT - 1));
+
+		for (int offset = 1; offset <= SLOT_COUNT; ++offset) {
+			std::vector<Timer>* slot = &this->slots[level][(currentSlot + offset) & (SLOT_COUNT - 1)];
+			bool hasActiveTimer = false;
+			for (Timer& timer : *slot) {
+				if (this->activeTimers.count(timer.id) > 0) {
+					earliestTick = std::min(earliestTick, timer.tick);
+					hasActiveTimer = true;
+				}
+			}
+			if (hasActiveTimer)
+				break;
+		}
+	}
+
+	return earliestTick * TICK_DURATION;
+}
+int gui::TimerWheel::getTimerCount() {
+	return (int)this->activeTimers.size();
+}
+void gui::TimerWheel::place(Timer timer) {
+	if (timer.tick <= this->currentTick) {
+		this->overdueTimers.push_back(std::move(timer));
+		return;
+	}
+
+	long long tick = timer.tick;
+	long long delta = tick - this->currentTick;
+
+	for (int level = 0; level < LEVEL_COUNT; ++level) {
+		int shift = level * SLOT_BITS;
+		bool isLastLevel = level == LEVEL_COUNT - 1;
+		if (delta < (1LL << (shift + SLOT_BITS)) || isLastLevel) {
+			// Further away than the wheel reaches, wait in the last slot and be placed again from there
+			if (delta >= (1LL << (shift + SLOT_BITS)))
+				tick = this->currentTick + (1LL << (shift + SLOT_BITS)) - 1;
+
+			int slot = (int)((tick >> shift) & (SLOT_COUNT - 1));
+			this->slots[level][slot].push_back(std::move(timer));
+			return;
+		}
+	}
+}
+void gui::TimerWheel::cascade(int level) {
+	if (level >= LEVEL_COUNT)
+		return;
+
+	// A level moves on a slot whenever all levels below it wrapped around
+	int shift = level * SLOT_BITS;
+	if ((this->currentTick & ((1LL << shift) - 1)) != 0)
+		return;
+	this->cascade(level + 1);
+
+	std::vector<Timer> timers;
+	timers.swap(this->slots[level][(this->currentTick >> shift) & (SLOT_COUNT - 1)]);
+	for (Timer& timer : timers) {
+		if (this->activeTimers.count(timer.id) > 0)
+			this->place(std::move(timer));
+	}
+}
+void gui::TimerWheel::collectDue(std::vector<Timer>* slot, std::vector<Timer>* due) {
+	for (Timer& timer : *slot) {
+		if (this->activeTimers.count(timer.id) > 0)
+			due->push_back(std::move(timer));
+	}
+	slot->clear();
+}
+void gui::TimerWheel::jumpTo(long long tick, std::vector<Timer>* due) {
+	std::vector<Timer> waiting;
+	for (int level = 0; level < LEVEL_COUNT; ++level) {
+		for (int slot = 0; slot < SLOT_COUNT; ++slot) {
+			for (Timer& timer : this->slots[level][slot]) {
+				if (this->activeTimers.count(timer.id) == 0)
+					continue;
+				if (timer.tick <= tick)
+					due->push_back(std::move(timer));
+				else
+					waiting.push_back(std::move(timer));
+			}
+			this->slots[level][slot].clear();
+		}
+	}
+
+	// Timers that became due together run in the order of their time
+	std::stable_sort(due->begin(), due->end(), [](const Timer& a, const Timer& b) {
+		return a.tick < b.tick;
+	});
+
+	this->currentTick = tick;
+	for (Timer& timer : waiting) {
+		this->place(std::move(timer));
+	}
+}
+long long gui::TimerWheel::toTick(double time) {
+	// Rounded up, so a callback never runs before its time
+	return (long long)std::ceil(time / TICK_DURATION);
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <functional>
+
+namespace gui {
+
+	class TimerWheel {
+		/*
+			Runs callbacks once their time is reached, so nothing has to check the time every frame.
+			Timers are kept in a hierarchical wheel: the lowest level has a slot per millisecond and every next level
+			covers a whole revolution of the level below per slot. Timers move down a level whenever the level below wraps,
+			so scheduling and cancelling take constant time, however many timers there are.
+			Times are in seconds, like glfwGetTime. Only used on the main thread.
+		*/
+		public:
+			static const int INVALID_TIMER = -1;
+
+			TimerWheel();
+
+			// Callback runs from advance once the time is reached, returns an id to cancel it with
+			int schedule(double time, std::function<void()> callback);
+			void cancel(int timer);
+
+			// Runs the callbacks of all timers that are due, timers scheduled by them wait for the next call
+			void advance(double time);
+			// Earliest time a timer is due, infinity if there are none
+			double getNextDeadline();
+			int getTimerCount();
+
+		private:
+			struct Timer {
+				int id;
+				long long tick;
+				std::function<void()> callback;
+			};
+
+			static const int SLOT_BITS = 6;
+			static const int SLOT_COUNT = 1 << SLOT_BITS;
+			static const int LEVEL_COUNT = 4;
+
+			std::vector<Timer> slots[LEVEL_COUNT][SLOT_COUNT];
+			// Scheduled for a time that already passed, these run on the next advance
+			std::vector<Timer> overdueTimers;
+			// Scheduled timers by id, cancelled ones are only dropped from their slot once it is reached
+			std::unordered_map<int, long long> activeTimers;
+			long long currentTick;
+			int nextID;
+
+			void place(Timer timer);
+			void cascade(int level);
+			void collectDue(std::vector<Timer>* slot, std::vector<Timer>* due);
+			void jumpTo(long long tick, std::vector<Timer>* due);
+
+			static long long toTick(double time);
+	};
+}
\ No newline at end of file
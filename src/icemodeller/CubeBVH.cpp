@@ -0,0 +1,398 @@
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+#include "CubeBVH.h"
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define CUBE_BVH_USE_SSE
+#include <emmintrin.h>
+#endif
+
+// Smallest direction component a ray is divided by, so rays parallel to a slab don't divide by zero
+static const float RAY_EPSILON = 1e-8f;
+static const int MAX_TREE_DEPTH = 64;
+
+static float safeInverse(float value) {
+	float magnitude = std::max(std::fabs(value), RAY_EPSILON);
+	return 1.0f / (value < 0.0f ? -magnitude : magnitude);
+}
+
+// CubeBVH
+CubeBVH::CubeBVH() {
+	this->builtModel = nullptr;
+}
+void CubeBVH::update(Model* model) {
+	if (model != this->builtModel || model->hasStructureChanged()) {
+		this->rebuild(model);
+	} else if (!model->getChangedCubes()->empty()) {
+		this->refit(model);
+	}
+}
+void CubeBVH::findVisibleCubes(const render::Frustum& frustum, std::vector<int>* visibleCubes) {
+	this->collectCubes(frustum, false, visibleCubes);
+}
+void CubeBVH::findCubesInFrustum(const render::Frustum& frustum, std::vector<int>* cubes) {
+	this->collectCubes(frustum, true, cubes);
+}
+int CubeBVH::pickCube(glm::vec3 origin, glm::vec3 direction, float* distance) {
+	struct StackEntry {
+		int node;
+		float entryDistance;
+	};
+
+	int nearestCube = -1;
+	float nearestDistance = FLT_MAX;
+	glm::vec3 inverseDirection = glm::vec3(safeInverse(direction.x), safeInverse(direction.y), safeInverse(direction.z));
+
+	StackEntry stack[MAX_TREE_DEPTH * 2];
+	int stackSize = 0;
+
+	float rootDistance;
+	if (!this->nodes.empty() && CubeBVH::intersectsBounds(this->nodes[0].bounds, origin, inverseDirection, nearestDistance, &rootDistance))
+		stack[stackSize++] = { 0, rootDistance };
+
+	while (stackSize > 0) {
+		StackEntry entry = stack[--stackSize];
+		if (entry.entryDistance >= nearestDistance)
+			continue;
+
+		const Node* node = &this->nodes[entry.node];
+		if (node->isLeaf()) {
+			int cube = CubeBVH::intersectPacket(this->packets[node->packet], origin, direction, &nearestDistance);
+			if (cube >= 0)
+				nearestCube = cube;
+			continue;
+		}
+
+		float leftDistance;
+		float rightDistance;
+		bool hitsLeft = CubeBVH::intersectsBounds(this->nodes[node->left].bounds, origin, inverseDirection, nearestDistance, &leftDistance);
+		bool hitsRight = CubeBVH::intersectsBounds(this->nodes[node->right].bounds, origin, inverseDirection, nearestDistance, &rightDistance);
+
+		// Visit the nearer child first, so the other one is more likely to be skipped
+		if (hitsLeft && hitsRight && leftDistance < rightDistance) {
+			stack[stackSize++] = { node->right, rightDistance };
+			stack[stackSize++] = { node->left, leftDistance };
+		} else {
+			if (hitsLeft)
+				stack[stackSize++] = { node->left, leftDistance };
+			if (hitsRight)
+				stack[stackSize++] = { node->right, rightDistance };
+		}
+	}
+
+	if (nearestCube >= 0 && distance != nullptr)
+		*distance = nearestDistance;
+	return nearestCube;
+}
+void CubeBVH::collectCubes(const render::Frustum& frustum, bool testOrientedBoxes, std::vector<int>* cubes) {
+	if (this->nodes.empty())
+		return;
+
+	size_t firstVisible = cubes->size();
+	std::vector<int> stack;
+	stack.push_back(0);
+
+	while (!stack.empty()) {
+		Node* node = &this->nodes[stack.back()];
+		stack.pop_back();
+
+		render::Frustum::Containment containment = frustum.test(node->bounds);
+		if (containment == render::Frustum::Containment::OUTSIDE)
+			continue;
+
+		if (containment == render::Frustum::Containment::INSIDE) {
+			cubes->insert(cubes->end(), this->cubeOrder.begin() + node->firstCube, this->cubeOrder.begin() + node->firstCube + node->cubeCount);
+		} else if (node->isLeaf()) {
+			for (int i = node->firstCube; i < node->firstCube + node->cubeCount; ++i) {
+				int cube = this->cubeOrder[i];
+				if (!frustum.intersects(this->cubeBounds[cube]))
+					continue;
+
+				if (testOrientedBoxes) {
+					// Bounds of rotated cubes are larger than the cubes themselves
+					glm::vec3 corners[8];
+					this->cubeBoxes[cube].getCorners(corners);
+					if (!frustum.intersects(corners, 8))
+						continue;
+				}
+				cubes->push_back(cube);
+			}
+		} else {
+			stack.push_back(node->right);
+			stack.push_back(node->left);
+		}
+	}
+
+	std::sort(cubes->begin() + firstVisible, cubes->end());
+}
+bool CubeBVH::isEmpty() {
+	return this->nodes.empty();
+}
+render::BoundingBox CubeBVH::getBounds() {
+	return this->nodes.empty() ? render::BoundingBox() : this->nodes[0].bounds;
+}
+render::BoundingBox CubeBVH::getCubeBounds(int cubeIndex) {
+	return this->cubeBounds[cubeIndex];
+}
+render::BoundingBox CubeBVH::calculateCubeBounds(Cube* cube) {
+	// Cube vertices span from -0.5 to size - 0.5 before the model matrix
+	render::BoundingBox localBounds;
+	localBounds.minimum = glm::vec3(-0.5f);
+	localBounds.maximum = cube->getSize() - glm::vec3(0.5f);
+
+	return render::BoundingBox::transform(localBounds, cube->getModelMatrix());
+}
+OrientedBox CubeBVH::calculateCubeBox(Cube* cube) {
+	glm::mat4 modelMatrix = cube->getModelMatrix();
+	glm::vec3 size = cube->getSize();
+
+	OrientedBox box;
+	box.center = glm::vec3(modelMatrix * glm::vec4(size * 0.5f - glm::vec3(0.5f), 1.0f));
+	for (int axis = 0; axis < 3; ++axis) {
+		box.axes[axis] = glm::normalize(glm::vec3(modelMatrix[axis]));
+		box.halfSize[axis] = std::fabs(size[axis]) * 0.5f;
+	}
+	return box;
+}
+void CubeBVH::rebuild(Model* model) {
+	std::vector<Cube>* cubes = model->getCubes();
+	int cubeCount = (int)cubes->size();
+
+	this->nodes.clear();
+	this->packets.clear();
+	this->cubeOrder.resize(cubeCount);
+	this->cubeLeaf.resize(cubeCount);
+	this->cubeBounds.resize(cubeCount);
+	this->cubeBoxes.resize(cubeCount);
+
+	for (int i = 0; i < cubeCount; ++i) {
+		this->cubeOrder[i] = i;
+		this->cubeBounds[i] = CubeBVH::calculateCubeBounds(&(*cubes)[i]);
+		this->cubeBoxes[i] = CubeBVH::calculateCubeBox(&(*cubes)[i]);
+	}
+
+	if (cubeCount > 0)
+		this->buildNode(0, cubeCount, -1);
+
+	this->builtModel = model;
+}
+int CubeBVH::buildNode(int firstCube, int cubeCount, int parent) {
+	int nodeIndex = (int)this->nodes.size();
+	this->nodes.push_back(Node());
+	this->nodes[nodeIndex].parent = parent;
+	this->nodes[nodeIndex].firstCube = firstCube;
+	this->nodes[nodeIndex].cubeCount = cubeCount;
+
+	auto begin = this->cubeOrder.begin() + firstCube;
+	auto end = begin + cubeCount;
+
+	render::BoundingBox bounds = this->cubeBounds[*begin];
+	render::BoundingBox centers;
+	centers.minimum = bounds.getCenter();
+	centers.maximum = bounds.getCenter();
+	for (auto it = begin; it != end; ++it) {
+		bounds.expand(this->cubeBounds[*it]);
+		centers.expand(this->cubeBounds[*it].getCenter());
+	}
+	this->nodes[nodeIndex].bounds = bounds;
+
+	if (cubeCount <= MAX_LEAF_CUBES) {
+		LeafPacket packet = LeafPacket();
+		packet.cubeCount = cubeCount;
+		this->nodes[nodeIndex].packet = (int)this->packets.size();
+		this->packets.push_back(packet);
+
+		for (auto it = begin; it != end; ++it) {
+			this->cubeLeaf[*it] = nodeIndex;
+			this->updatePacketLane(*it);
+		}
+		return nodeIndex;
+	}
+
+	// Split at the median along the axis the centers are spread out the most
+	glm::vec3 extent = centers.maximum - centers.minimum;
+	int axis = 0;
+	if (extent.y > extent[axis])
+		axis = 1;
+	if (extent.z > extent[axis])
+		axis = 2;
+
+	int leftCount = cubeCount / 2;
+	std::nth_element(begin, begin + leftCount, end, [&](int a, int b) {
+		return this->cubeBounds[a].getCenter()[axis] < this->cubeBounds[b].getCenter()[axis];
+	});
+
+	// Children are added after their parent, nodes can't be referenced across these calls
+	int left = this->buildNode(firstCube, leftCount, nodeIndex);
+	int right = this->buildNode(firstCube + leftCount, cubeCount - leftCount, nodeIndex);
+	this->nodes[nodeIndex].left = left;
+	this->nodes[nodeIndex].right = right;
+
+	return nodeIndex;
+}
+void CubeBVH::refit(Model* model) {
+	std::vector<Cube>* cubes = model->getCubes();
+	std::vector<int>* changedCubes = model->getChangedCubes();
+
+	for (auto it = changedCubes->begin(); it != changedCubes->end(); ++it) {
+		this->cubeBounds[*it] = CubeBVH::calculateCubeBounds(&(*cubes)[*it]);
+		this->cubeBoxes[*it] = CubeBVH::calculateCubeBox(&(*cubes)[*it]);
+		this->updatePacketLane(*it);
+	}
+
+	for (auto it = changedCubes->begin(); it != changedCubes->end(); ++it) {
+		// Stop early once an ancestor's bounds don't change anymore
+		int nodeIndex = this->cubeLeaf[*it];
+		while (nodeIndex >= 0) {
+			render::BoundingBox previous = this->nodes[nodeIndex].bounds;
+			this->refitNode(nodeIndex);
+
+			Node* node = &this->nodes[nodeIndex];
+			if (node->bounds.minimum == previous.minimum && node->bounds.maximum == previous.maximum && nodeIndex != this->cubeLeaf[*it])
+				break;
+			nodeIndex = node->parent;
+		}
+	}
+}
+void CubeBVH::refitNode(int nodeIndex) {
+	Node* node = &this->nodes[nodeIndex];
+
+	if (node->isLeaf()) {
+		node->bounds = this->cubeBounds[this->cubeOrder[node->firstCube]];
+		for (int i = 1; i < node->cubeCount; ++i) {
+			node->bounds.expand(this->cubeBounds[this->cubeOrder[node->firstCube + i]]);
+		}
+	} else {
+		node->bounds = this->nodes[node->left].bounds;
+		node->bounds.expand(this->nodes[node->right].bounds);
+	}
+}
+
+void CubeBVH::updatePacketLane(int cubeIndex) {
+	const Node* leaf = &this->nodes[this->cubeLeaf[cubeIndex]];
+	LeafPacket* packet = &this->packets[leaf->packet];
+	const OrientedBox* box = &this->cubeBoxes[cubeIndex];
+
+	int lane = 0;
+	while (this->cubeOrder[leaf->firstCube + lane] != cubeIndex)
+		++lane;
+
+	packet->cubes[lane] = cubeIndex;
+	for (int axis = 0; axis < 3; ++axis) {
+		packet->center[axis][lane] = box->center[axis];
+		packet->halfSize[axis][lane] = box->halfSize[axis];
+		for (int component = 0; component < 3; ++component) {
+			packet->axes[axis][component][lane] = box->axes[axis][component];
+		}
+	}
+}
+bool CubeBVH::intersectsBounds(const render::BoundingBox& bounds, glm::vec3 origin, glm::vec3 inverseDirection, float maxDistance, float* entryDistance) {
+	float tNear = 0.0f;
+	float tFar = maxDistance;
+
+	for (int axis = 0; axis < 3; ++axis) {
+		float t1 = (bounds.minimum[axis] - origin[axis]) * inverseDirection[axis];
+		float t2 = (bounds.maximum[axis] - origin[axis]) * inverseDirection[axis];
+		tNear = std::max(tNear, std::min(t1, t2));
+		tFar = std::min(tFar, std::max(t1, t2));
+	}
+
+	*entryDistance = tNear;
+	return tNear <= tFar;
+}
+int CubeBVH::intersectPacket(const LeafPacket& packet, glm::vec3 origin, glm::vec3 direction, float* distance) {
+	// Slab test in the frame of every box, entry distances end up in hitDistances
+	float hitDistances[MAX_LEAF_CUBES];
+	int hitMask = 0;
+
+#ifdef CUBE_BVH_USE_SSE
+	const __m128 epsilon = _mm_set1_ps(RAY_EPSILON);
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+
+	__m128 toCenter[3];
+	for (int component = 0; component < 3; ++component) {
+		toCenter[component] = _mm_sub_ps(_mm_loadu_ps(packet.center[component]), _mm_set1_ps(origin[component]));
+	}
+
+	__m128 tNear = _mm_setzero_ps();
+	__m128 tFar = _mm_set1_ps(*distance);
+
+	for (int axis = 0; axis < 3; ++axis) {
+		__m128 e = _mm_setzero_ps();
+		__m128 f = _mm_setzero_ps();
+		for (int component = 0; component < 3; ++component) {
+			__m128 axisComponent = _mm_loadu_ps(packet.axes[axis][component]);
+			e = _mm_add_ps(e, _mm_mul_ps(axisComponent, toCenter[component]));
+			f = _mm_add_ps(f, _mm_mul_ps(axisComponent, _mm_set1_ps(direction[component])));
+		}
+
+		// Keep the sign of f, but never let it get closer to zero than epsilon
+		__m128 sign = _mm_and_ps(f, signBit);
+		f = _mm_or_ps(_mm_max_ps(_mm_andnot_ps(signBit, f), epsilon), sign);
+
+		__m128 halfSize = _mm_loadu_ps(packet.halfSize[axis]);
+		__m128 t1 = _mm_div_ps(_mm_add_ps(e, halfSize), f);
+		__m128 t2 = _mm_div_ps(_mm_sub_ps(e, halfSize), f);
+		tNear = _mm_max_ps(tNear, _mm_min_ps(t1, t2));
+		tFar = _mm_min_ps(tFar, _mm_max_ps(t1, t2));
+	}
+
+	hitMask = _mm_movemask_ps(_mm_cmple_ps(tNear, tFar));
+	_mm_storeu_ps(hitDistances, tNear);
+#else
+	for (int lane = 0; lane < packet.cubeCount; ++lane) {
+		float tNear = 0.0f;
+		float tFar = *distance;
+
+		for (int axis = 0; axis < 3; ++axis) {
+			float e = 0.0f;
+			float f = 0.0f;
+			for (int component = 0; component < 3; ++component) {
+				e += packet.axes[axis][component][lane] * (packet.center[component][lane] - origin[component]);
+				f += packet.axes[axis][component][lane] * direction[component];
+			}
+			float inverseF = safeInverse(f);
+
+			float t1 = (e + packet.halfSize[axis][lane]) * inverseF;
+			float t2 = (e - packet.halfSize[axis][lane]) * inverseF;
+			tNear = std::max(tNear, std::min(t1, t2));
+			tFar = std::min(tFar, std::max(t1, t2));
+		}
+
+		hitDistances[lane] = tNear;
+		if (tNear <= tFar)
+			hitMask |= 1 << lane;
+	}
+#endif
+
+	// Lanes after the last cube hold no box
+	hitMask &= (1 << packet.cubeCount) - 1;
+
+	int nearestCube = -1;
+	for (int lane = 0; lane < packet.cubeCount; ++lane) {
+		if ((hitMask & (1 << lane)) && hitDistances[lane] < *distance) {
+			*distance = hitDistances[lane];
+			nearestCube = packet.cubes[lane];
+		}
+	}
+	return nearestCube;
+}
+
+// CubeBVH::Node
+bool CubeBVH::Node::isLeaf() const {
+	return this->left < 0;
+}
+
+// OrientedBox
+void OrientedBox::getCorners(glm::vec3 corners[8]) const {
+	for (int corner = 0; corner < 8; ++corner) {
+		glm::vec3 point = this->center;
+		for (int axis = 0; axis < 3; ++axis) {
+			float side = (corner & (1 << axis)) ? 1.0f : -1.0f;
+			point += this->axes[axis] * (side * this->halfSize[axis]);
+		}
+		corners[corner] = point;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "../gui/Gui.h"
+#include "../render/Frustum.h"
+#include "Model.h"
+
+// Cubes in a node before it is split, also the width of a leaf packet
+const int MAX_LEAF_CUBES = 4;
+
+struct OrientedBox {
+	glm::vec3 center;
+	glm::vec3 axes[3];		// Unit length
+	glm::vec3 halfSize;
+
+	void getCorners(glm::vec3 corners[8]) const;
+};
+
+class CubeBVH {
+	/*
+		Bounding volume hierarchy over the world space bounds of all cubes of a model.
+		Edited cubes only refit the bounds of their ancestors, the tree is rebuilt when cubes are added.
+		Every node covers a contiguous range of cubes, so whole subtrees are collected without testing them.
+		Leaves keep the oriented boxes of their cubes side by side, so rays are tested against all of them at once.
+	*/
+	public:
+		CubeBVH();
+
+		// Brings the tree up to date with the changes the model recorded since the previous frame
+		void update(Model* model);
+
+		// Collects the indices of cubes that may be visible, in ascending order
+		void findVisibleCubes(const render::Frustum& frustum, std::vector<int>* visibleCubes);
+		// Collects the indices of cubes whose rotated box lies at least partly inside the frustum, in ascending order
+		void findCubesInFrustum(const render::Frustum& frustum, std::vector<int>* cubes);
+		// Nearest cube hit by the ray, or -1 if there is none
+		int pickCube(glm::vec3 origin, glm::vec3 direction, float* distance);
+
+		bool isEmpty();
+		render::BoundingBox getBounds();
+		render::BoundingBox getCubeBounds(int cubeIndex);
+
+		static render::BoundingBox calculateCubeBounds(Cube* cube);
+		static OrientedBox calculateCubeBox(Cube* cube);
+
+	private:
+		struct Node {
+			render::BoundingBox bounds;
+			int parent = -1;
+			int left = -1;
+			int right = -1;
+			int firstCube = 0;		// Range in cubeOrder
+			int cubeCount = 0;
+			int packet = -1;		// Only for leaves
+
+			bool isLeaf() const;
+		};
+
+		// Oriented boxes of the cubes in a leaf, one lane per cube
+		struct LeafPacket {
+			float center[3][MAX_LEAF_CUBES];
+			float axes[3][3][MAX_LEAF_CUBES];		// Axis, component, lane
+			float halfSize[3][MAX_LEAF_CUBES];
+			int cubes[MAX_LEAF_CUBES];
+			int cubeCount;
+		};
+
+		std::vector<Node> nodes;
+		std::vector<int> cubeOrder;
+		std::vector<int> cubeLeaf;
+		std::vector<render::BoundingBox> cubeBounds;
+		std::vector<OrientedBox> cubeBoxes;
+		std::vector<LeafPacket> packets;
+		Model* builtModel;
+
+		void rebuild(Model* model);
+		int buildNode(int firstCube, int cubeCount, int parent);
+		void refit(Model* model);
+		void refitNode(int nodeIndex);
+		void updatePacketLane(int cubeIndex);
+		void collectCubes(const render::Frustum& frustum, bool testOrientedBoxes, std::vector<int>* cubes);
+
+		static bool intersectsBounds(const render::BoundingBox& bounds, glm::vec3 origin, glm::vec3 inverseDirection, float maxDistance, float* entryDistance);
+		static int intersectPacket(const LeafPacket& packet, glm::vec3 origin, glm::vec3 direction, float* distance);
+};
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include <algorithm>
+
+#include "CubeEditor.h"
+
+// CubeEditor
+CubeEditor::CubeEditor(Model* model) {
+	this->model = model;
+	this->selectedCube = -1;
+
+	for (int axis = 0; axis < 3; ++axis) {
+		this->sizeInputs[axis] = nullptr;
+	}
+}
+void CubeEditor::selectCube(int index) {
+	this->selectedCube = index;
+	this->updateInputs();
+}
+int CubeEditor::getSelectedCube() {
+	return this->selectedCube;
+}
+void CubeEditor::onSelectionChange(std::vector<int>* selectedCubes) {
+	this->selectCube(selectedCubes->empty() ? -1 : selectedCubes->front());
+}
+void CubeEditor::setSizeInputs(gui::DoubleInput* sizeX, gui::DoubleInput* sizeY, gui::DoubleInput* sizeZ) {
+	this->sizeInputs[0] = sizeX;
+	this->sizeInputs[1] = sizeY;
+	this->sizeInputs[2] = sizeZ;
+
+	for (int axis = 0; axis < 3; ++axis) {
+		this->sizeInputs[axis]->setValueListener(new CubeSizeListener(this, axis));
+	}
+	this->updateInputs();
+}
+void CubeEditor::setSize(int axis, double value) {
+	if (this->selectedCube < 0)
+		return;
+
+	glm::vec3 size = (*this->model->getCubes())[this->selectedCube].getSize();
+	size[axis] = (float)std::max(value, 0.0);
+	this->model->setCubeSize(this->selectedCube, size);
+}
+void CubeEditor::updateInputs() {
+	if (this->selectedCube < 0)
+		return;
+
+	glm::vec3 size = (*this->model->getCubes())[this->selectedCube].getSize();
+	for (int axis = 0; axis < 3; ++axis) {
+		if (this->sizeInputs[axis] != nullptr)
+			this->sizeInputs[axis]->setValue(size[axis]);
+	}
+}
+
+// CubeSizeListener
+CubeSizeListener::CubeSizeListener(CubeEditor* editor, int axis) {
+	this->editor = editor;
+	this->axis = axis;
+}
+void CubeSizeListener::onValueChange(double value) {
+	this->editor->setSize(this->axis, value);
+}
\ No newline at end of file
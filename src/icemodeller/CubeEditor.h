@@ -0,0 +1,40 @@
+#pragma once
+
+#include "../gui/Gui.h"
+#include "Model.h"
+
+class CubeEditor : public SelectionListener {
+	/*
+		Applies values from the control panel to the selected cube of a model
+	*/
+	public:
+		CubeEditor(Model* model);
+
+		void selectCube(int index);
+		int getSelectedCube();
+
+		// Edits the first of the cubes selected in the model view
+		void onSelectionChange(std::vector<int>* selectedCubes) override;
+
+		void setSizeInputs(gui::DoubleInput* sizeX, gui::DoubleInput* sizeY, gui::DoubleInput* sizeZ);
+		void setSize(int axis, double value);
+
+	private:
+		Model* model;
+		int selectedCube;
+
+		gui::DoubleInput* sizeInputs[3];
+
+		void updateInputs();
+};
+
+class CubeSizeListener : public gui::ValueListener {
+	public:
+		CubeSizeListener(CubeEditor* editor, int axis);
+
+		void onValueChange(double value) override;
+
+	private:
+		CubeEditor* editor;
+		int axis;
+};
\ No newline at end of file
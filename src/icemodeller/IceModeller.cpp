@@ -4,6 +4,7 @@
 #include "IceModeller.h"
 #include "../gui/Gui.h"
 #include "ModelView.h"
+#include "CubeEditor.h"
 
 static const int DEFAULT_WINDOW_WIDTH = 1024;
 static const int DEFAULT_WINDOW_HEIGHT = 571;
@@ -11,6 +12,9 @@ static const int MINIMAL_WINDOW_WIDTH = 1024;
 static const int MINIMAL_WINDOW_HEIGHT = 571;
 static const char* TITLE = "IceModeller v1.0";
 
+// Samples per pixel of the model view, the rest of the window has a single one
+static const int MODEL_VIEW_SAMPLE_COUNT = 4;
+
 static const glm::vec4 BACKGROUND_COLOR = glm::vec4(0.12, 0.12, 0.12, 1.0);
 static const glm::vec4 BACKGROUND_COLOR2 = glm::vec4(0.153, 0.153, 0.153, 1.0);
 
@@ -138,24 +142,30 @@ IceModeller::IceModeller() {
 
 	Model* testModel = new Model();
 	Cube tCube1 = Cube(glm::vec3(4.0, 0.0, 7.0), glm::vec3(2.0, 1.0, 2.0), Rotation{glm::vec3(0.0, 0.0, 0.0), RotationAxis::X, 0.0f});
-	testModel->getCubes()->push_back(tCube1);
+	testModel->addCube(tCube1);
 
 	Cube tCube2 = Cube(glm::vec3(13.0, 2.0, 4.0), glm::vec3(2.0, 1.0, 2.0), Rotation{glm::vec3(0.0, 0.0, 0.0), RotationAxis::X, 0.0f});
-	testModel->getCubes()->push_back(tCube2);
+	testModel->addCube(tCube2);
 
 	//Cube tCube3 = Cube(glm::vec3(0.0, 0.0, 0.0), glm::vec3(16.0, 0.5, 16.0), Rotation{glm::vec3(0.0, 0.0, 0.0), RotationAxis::X, 10.0f});
-	//testModel->getCubes()->push_back(tCube3);
+	//testModel->addCube(tCube3);
 
 	Cube tCube4 = Cube(glm::vec3(0.0, 0.0, 0.0), glm::vec3(1.0, 1.0, 1.0), Rotation{glm::vec3(0.5, 0.5, 0.5), RotationAxis::Y, 45.0f});
-	testModel->getCubes()->push_back(tCube4);
+	testModel->addCube(tCube4);
 
 	ModelViewPanel* modelView = new ModelViewPanel();
 	modelView->preferredSide = gui::Side::CENTER;
 	modelView->setBackgroundColor(glm::vec4(0.7, 0.7, 0.7, 1.0));
 	modelView->setOpaque(true);
+	modelView->setAntiAliasing(ModelViewPanel::AntiAliasing::MULTISAMPLE, MODEL_VIEW_SAMPLE_COUNT);
 	modelView->setViewedModel(testModel);
 	gui::Gui::mainWindow->addElement(modelView);
 
+	CubeEditor* cubeEditor = new CubeEditor(testModel);
+	cubeEditor->setSizeInputs(sizeX, sizeY, sizeZ);
+	modelView->setSelectionListener(cubeEditor);
+	modelView->setSelectedCubes({ 0 });
+
 	//gui::Panel* modelView = new gui::Panel();
 	//modelView->preferredSide = gui::Side::CENTER;
 	//modelView->setBackgroundColor(glm::vec4(1.0, 0.0, 0.0, 1.0));
@@ -165,9 +175,17 @@ IceModeller::IceModeller() {
 
 
 void IceModeller::start() {
-	while (!gui::Gui::mainWindow->shoudClose()) {
+	// Frames are only drawn when something changed, the loop sleeps in between
+	while (gui::Gui::mainWindow->waitForRedraw()) {
 		gui::Gui::mainWindow->draw();
 	}
+
+	// Whatever is still alive here is either owned for the whole run or leaked
+	render::GpuResource::printStatistics();
+	render::BufferArena::getVertexArena()->printStatistics();
+	render::BufferArena::getIndexArena()->printStatistics();
+	AssetCache::getInstance()->printStatistics();
+	render::GlState::getInstance()->printStatistics();
 }
 void framebufferSizeCallback(GLFWwindow* glfwWindow, int width, int height) {
 	gui::Gui::mainWindow->updateWindowSize(width, height);
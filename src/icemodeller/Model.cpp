@@ -1,6 +1,6 @@
-#include <glad/glad.h>
-
 #include <iostream>
+#include <cmath>
+#include <gtc/matrix_transform.hpp>
 
 #include "Model.h"
 
@@ -15,15 +15,13 @@ Cube::Cube() {
 	this->rotation.axis = RotationAxis::X;
 
 	this->shade = true;
-	
-	this->vao = this->createCubeVAO();
 
-	this->faces[0].texture = nullptr;
-	this->faces[1].texture = nullptr;
-	this->faces[2].texture = nullptr;
-	this->faces[3].texture = nullptr;
-	this->faces[4].texture = nullptr;
-	this->faces[5].texture = nullptr;
+	this->faces[0].textureLayer = -1;
+	this->faces[1].textureLayer = -1;
+	this->faces[2].textureLayer = -1;
+	this->faces[3].textureLayer = -1;
+	this->faces[4].textureLayer = -1;
+	this->faces[5].textureLayer = -1;
 }
 Cube::Cube(glm::vec3 position, glm::vec3 size, Rotation rotation) {
 	this->position = position;
@@ -32,14 +30,13 @@ Cube::Cube(glm::vec3 position, glm::vec3 size, Rotation rotation) {
 	this->rotation = rotation;
 
 	this->shade = false;
-	this->vao = this->createCubeVAO();
 
-	this->faces[0].texture = nullptr;
-	this->faces[1].texture = nullptr;
-	this->faces[2].texture = nullptr;
-	this->faces[3].texture = nullptr;
-	this->faces[4].texture = nullptr;
-	this->faces[5].texture = nullptr;
+	this->faces[0].textureLayer = -1;
+	this->faces[1].textureLayer = -1;
+	this->faces[2].textureLayer = -1;
+	this->faces[3].textureLayer = -1;
+	this->faces[4].textureLayer = -1;
+	this->faces[5].textureLayer = -1;
 }
 glm::vec3 Cube::getPosition() {
 	return this->position;
@@ -53,101 +50,123 @@ Rotation Cube::getRotation() {
 float Cube::getRotationAngleInRadians() {
 	return (float) (this->rotation.angleDegrees * (PI / 180));
 }
-unsigned int Cube::getVAO() {
-	return this->vao;
-}
-bool Cube::hasTextureAtFace(CubeFace::Orientation orientation) {
-	return this->faces[orientation].texture != nullptr;
-}
-
-std::vector<float> Cube::getCubeVertices() {
-	std::vector<float> vertices = {
-		// X			Y				Z					TexX	TexY
-		// North face
-		-0.5f,			-0.5f,			-0.5f,				1.0f, 0.0f, // A - 0
-		size.x - 0.5f,	-0.5f,			-0.5f,				0.0f, 0.0f, // B - 1
-		size.x - 0.5f,  size.y - 0.5f,	-0.5f,				0.0f, 1.0f, // F - 2
-		-0.5f,			size.y - 0.5f,	-0.5f,				1.0f, 1.0f, // E - 3
-
-		// East face
-		size.x - 0.5f,	-0.5f,			-0.5f,				1.0f, 0.0f, // B - 4
-		size.x - 0.5f,	-0.5f,			size.z - 0.5f,		0.0f, 0.0f, // C - 5
-		size.x - 0.5f,	size.y - 0.5f,	size.z - 0.5f,		0.0f, 1.0f, // G - 6
-		size.x - 0.5f,	size.y - 0.5f,	-0.5f,				1.0f, 1.0f, // F - 7
-
-		// South face
-		size.x - 0.5f,	-0.5f,			size.z - 0.5f,		1.0f, 0.0f, // C - 8
-		-0.5f,			-0.5f,			size.z - 0.5f,		0.0f, 0.0f, // D - 9
-		-0.5f,			size.y - 0.5f,	size.z - 0.5f,		0.0f, 1.0f, // H - 10
-		size.x - 0.5f,	size.y - 0.5f,	size.z - 0.5f,		1.0f, 1.0f, // G - 11
-
-		// West face
-		-0.5f,			-0.5f,			size.z - 0.5f,		1.0f, 0.0f, // D - 12
-		-0.5f,			-0.5f,			-0.5f,				0.0f, 0.0f, // A - 13
-		-0.5f,			size.y - 0.5f,	-0.5f,				0.0f, 1.0f, // E - 14
-		-0.5f,			size.y - 0.5f,	size.z - 0.5f,		1.0f, 1.0f, // H - 15
-
-		// Top face
-		-0.5f,			size.y - 0.5f,	-0.5f,				1.0f, 0.0f, // E - 16
-		size.x - 0.5f,	size.y - 0.5f,	-0.5f,				0.0f, 0.0f, // F - 17
-		size.x - 0.5f,	size.y - 0.5f,	size.z - 0.5f,		0.0f, 1.0f, // G - 18
-		-0.5f,			size.y - 0.5f,	size.z - 0.5f,		1.0f, 1.0f, // H - 19
-
-		// Bottom face
-		-0.5f,			-0.5f,			size.z - 0.5f,		1.0f, 0.0f, // D - 20
-		size.x - 0.5f,	-0.5f,			size.z - 0.5f,		0.0f, 0.0f, // C - 21
-		size.x - 0.5f,	-0.5f,			-0.5f,				0.0f, 1.0f, // B - 22
-		-0.5f,			-0.5f,			-0.5f,				1.0f, 1.0f, // A - 23
-	};
-	return vertices;
-}
-unsigned int Cube::createCubeVAO() {
-	const unsigned int cubeIndices[] = {
-		2, 1, 0,
-		3, 2, 0,
+glm::mat4 Cube::getModelMatrix() {
+	glm::mat4 modelMatrix = glm::mat4(1.0f);
 
-		6, 5, 4,
-		7, 6, 4,
+	// Move to pivot point
+	modelMatrix = glm::translate(modelMatrix, this->rotation.origin);
+	// Rotate around pivot point
+	modelMatrix = glm::rotate(modelMatrix, this->getRotationAngleInRadians(), this->rotation.getAxisVector());
+	// Move back from pivot point
+	modelMatrix = glm::translate(modelMatrix, -this->rotation.origin);
 
-		10, 9, 8,
-		11, 10, 8,
+	// Align cube with grid
+	modelMatrix = glm::translate(modelMatrix, glm::vec3(0.5, 0.5, 0.5));
 
-		14, 13, 12,
-		15, 14, 12,
+	// Move to position
+	modelMatrix = glm::translate(modelMatrix, this->position);
 
-		18, 17, 16,
-		19, 18, 16,
-
-		22, 21, 20,
-		23, 22, 20,
-	};
-
-	unsigned int VAO;
-	glGenVertexArrays(1, &VAO);
-	glBindVertexArray(VAO);
-
-	unsigned int VBO;
-	glGenBuffers(1, &VBO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, 120 * sizeof(float), &this->getCubeVertices()[0], GL_STATIC_DRAW);
-
-	unsigned int EBO;
-	glGenBuffers(1, &EBO);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cubeIndices), cubeIndices, GL_STATIC_DRAW);
-
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-	
-	return VAO;
+	return modelMatrix;
+}
+bool Cube::isAxisAligned() {
+	return std::fmod(this->rotation.angleDegrees, 360.0f) == 0.0f;
+}
+void Cube::setPosition(glm::vec3 position) {
+	this->position = position;
+}
+void Cube::setSize(glm::vec3 size) {
+	this->size = size;
+}
+void Cube::setRotation(Rotation rotation) {
+	this->rotation = rotation;
+}
+bool Cube::hasTextureAtFace(CubeFace::Orientation orientation) {
+	return this->faces[orientation].textureLayer >= 0;
+}
+CubeFace* Cube::getFace(CubeFace::Orientation orientation) {
+	return &this->faces[orientation];
+}
+bool Cube::isFaceVisible(CubeFace::Orientation orientation) {
+	if (this->faces[orientation].hidden)
+		return false;
+
+	// Faces of flat cubes collapse to a line and have nothing to show
+	switch (orientation) {
+		case CubeFace::Orientation::NORTH:
+		case CubeFace::Orientation::SOUTH:
+			return this->size.x > 0.0f && this->size.y > 0.0f;
+		case CubeFace::Orientation::EAST:
+		case CubeFace::Orientation::WEST:
+			return this->size.z > 0.0f && this->size.y > 0.0f;
+		case CubeFace::Orientation::UP:
+		case CubeFace::Orientation::DOWN:
+			return this->size.x > 0.0f && this->size.z > 0.0f;
+		default:
+			return true;
+	}
+}
+void Cube::setFaceHidden(CubeFace::Orientation orientation, bool hidden) {
+	this->faces[orientation].hidden = hidden;
+}
+void Cube::setFaceTexture(CubeFace::Orientation orientation, int textureLayer, glm::vec2 uvBegin, glm::vec2 uvEnd) {
+	this->faces[orientation].textureLayer = textureLayer;
+	this->faces[orientation].uvBegin = uvBegin;
+	this->faces[orientation].uvEnd = uvEnd;
 }
 
 Model::Model() {
 	this->ambientOcclusion = false;
+	this->revision = 0;
+	this->structureChanged = false;
 }
 std::vector<Cube>* Model::getCubes() {
 	return &this->cubes;
+}
+void Model::addCube(Cube cube) {
+	this->cubes.push_back(cube);
+	this->isCubeChanged.push_back(false);
+	this->structureChanged = true;
+	this->markChanged();
+}
+void Model::setCubePosition(int index, glm::vec3 position) {
+	this->cubes[index].setPosition(position);
+	this->markCubeChanged(index);
+}
+void Model::setCubeSize(int index, glm::vec3 size) {
+	this->cubes[index].setSize(size);
+	this->markCubeChanged(index);
+}
+void Model::setCubeRotation(int index, Rotation rotation) {
+	this->cubes[index].setRotation(rotation);
+	this->markCubeChanged(index);
+}
+void Model::setCubeFaceTexture(int index, CubeFace::Orientation orientation, int textureLayer, glm::vec2 uvBegin, glm::vec2 uvEnd) {
+	this->cubes[index].setFaceTexture(orientation, textureLayer, uvBegin, uvEnd);
+	this->markCubeChanged(index);
+}
+void Model::markCubeChanged(int index) {
+	if (!this->isCubeChanged[index]) {
+		this->isCubeChanged[index] = true;
+		this->changedCubes.push_back(index);
+	}
+	this->markChanged();
+}
+unsigned int Model::getRevision() {
+	return this->revision;
+}
+void Model::markChanged() {
+	this->revision++;
+}
+std::vector<int>* Model::getChangedCubes() {
+	return &this->changedCubes;
+}
+bool Model::hasStructureChanged() {
+	return this->structureChanged;
+}
+void Model::clearChanges() {
+	for (auto it = this->changedCubes.begin(); it != this->changedCubes.end(); ++it) {
+		this->isCubeChanged[*it] = false;
+	}
+	this->changedCubes.clear();
+	this->structureChanged = false;
 }
\ No newline at end of file
@@ -25,17 +25,30 @@ struct Rotation {
 	}
 };
 
-struct Texture {
+// How a texture uses its alpha channel, which decides how faces with it are drawn
+enum class AlphaMode {
+	OPAQUE,			// Drawn without alpha testing or blending
+	CUTOUT,			// Pixels are either fully transparent or fully opaque, drawn with alpha testing
+	TRANSLUCENT		// Has pixels in between, blended and sorted back to front
+};
 
+struct Texture {
+	std::string path;
+	int layer = -1;		// Layer in the texture array of the TextureRegistry
+	int width = 0;
+	int height = 0;
+	bool isLoaded = false;	// A placeholder is shown until the image is decoded
+	AlphaMode alphaMode = AlphaMode::OPAQUE;
 };
 
 struct CubeFace {
-	//uv
-	glm::vec2 uvBegin;
-	glm::vec2 uvEnd;
-	//texture
-	Texture* texture;
-	int rotation;
+	//uv, in texture space from (0, 0) to (1, 1)
+	glm::vec2 uvBegin = glm::vec2(0.0f, 0.0f);
+	glm::vec2 uvEnd = glm::vec2(1.0f, 1.0f);
+	// Layer of the texture in the TextureRegistry, -1 if untextured
+	int textureLayer = -1;
+	int rotation = 0;	// Degrees, multiple of 90
+	bool hidden = false;
 
 	enum Orientation {
 		NORTH = 0,
@@ -58,12 +71,19 @@ class Cube {
 		glm::vec3 getSize();
 		Rotation getRotation();
 		float getRotationAngleInRadians();
-		unsigned int getVAO();
+		glm::mat4 getModelMatrix();
+		bool isAxisAligned();
+
+		void setPosition(glm::vec3 position);
+		void setSize(glm::vec3 size);
+		void setRotation(Rotation rotation);
 
 		bool hasTextureAtFace(CubeFace::Orientation orientation);
+		CubeFace* getFace(CubeFace::Orientation orientation);
+		bool isFaceVisible(CubeFace::Orientation orientation);
+		void setFaceHidden(CubeFace::Orientation orientation, bool hidden);
+		void setFaceTexture(CubeFace::Orientation orientation, int textureLayer, glm::vec2 uvBegin, glm::vec2 uvEnd);
 	private:
-		unsigned int vao;
-
 		glm::vec3 position;
 		glm::vec3 size;
 
@@ -71,9 +91,6 @@ class Cube {
 
 		bool shade;
 		CubeFace faces[6];
-
-		std::vector<float> getCubeVertices();
-		unsigned int createCubeVAO();
 };
 
 class Model {
@@ -81,10 +98,35 @@ class Model {
 		Model();
 
 		std::vector<Cube>* getCubes();
+		void addCube(Cube cube);
+
+		void setCubePosition(int index, glm::vec3 position);
+		void setCubeSize(int index, glm::vec3 size);
+		void setCubeRotation(int index, Rotation rotation);
+		void setCubeFaceTexture(int index, CubeFace::Orientation orientation, int textureLayer, glm::vec2 uvBegin, glm::vec2 uvEnd);
+		void markCubeChanged(int index);
+
+		// Every change to the model increments its revision
+		unsigned int getRevision();
+		void markChanged();
+
+		// Changes since the last call to clearChanges, so renderers only update what was edited
+		std::vector<int>* getChangedCubes();
+		bool hasStructureChanged();
+		void clearChanges();
 
 	private:
 		std::vector<Cube> cubes;
-		//std::vector<Texture> textures;
+		unsigned int revision;
+
+		std::vector<int> changedCubes;
+		std::vector<bool> isCubeChanged;
+		bool structureChanged;
 		bool ambientOcclusion;
 
+};
+
+class SelectionListener {
+	public:
+		virtual void onSelectionChange(std::vector<int>* selectedCubes) = 0;
 };
\ No newline at end of file
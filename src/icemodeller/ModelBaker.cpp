@@ -0,0 +1,367 @@
+#include <cmath>
+#include <map>
+#include <tuple>
+#include <algorithm>
+#include <cstring>
+
+#include "ModelBaker.h"
+
+// Positions closer together than this are treated as equal
+static const double PLANE_RESOLUTION = 4096.0;
+static const float UV_EPSILON = 0.00001f;
+
+// Increase when baking changes, so meshes cached by older versions are baked again
+static const unsigned int MESH_CACHE_VERSION = 3;
+static const std::string MESH_CACHE_KIND = "mesh";
+// Vertex count, index count and first cutout index in front of the mesh data
+static const int MESH_HEADER_SIZE = 3 * sizeof(unsigned int);
+// Smaller models bake faster than their cache entry is read
+static const int MIN_CACHED_CUBE_COUNT = 256;
+
+// Normal axis (x = 0, y = 1, z = 2) and whether the face points along or against it, by CubeFace::Orientation
+static const int faceAxis[6] = { 2, 0, 2, 0, 1, 1 };
+static const bool facePointsPositive[6] = { false, true, true, false, true, false };
+static const CubeFace::Orientation oppositeFace[6] = {
+	CubeFace::Orientation::SOUTH,
+	CubeFace::Orientation::WEST,
+	CubeFace::Orientation::NORTH,
+	CubeFace::Orientation::EAST,
+	CubeFace::Orientation::DOWN,
+	CubeFace::Orientation::UP
+};
+
+static long long quantize(float value) {
+	return std::llround(value * PLANE_RESOLUTION);
+}
+static long long getPlaneKey(int axis, bool isMaxSide, float planePosition) {
+	return quantize(planePosition) * 8 + axis * 2 + (isMaxSide ? 1 : 0);
+}
+static bool nearlyEqual(float a, float b) {
+	return std::fabs(a - b) <= UV_EPSILON;
+}
+
+BakedMesh ModelBaker::bake(std::vector<Cube> cubes, std::vector<AlphaMode> alphaModes, unsigned int revision, bool useCache) {
+	BakedMesh mesh;
+	mesh.revision = revision;
+
+	useCache = useCache && (int)cubes.size() >= MIN_CACHED_CUBE_COUNT;
+	unsigned long long key = 0;
+	if (useCache) {
+		key = ModelBaker::hashCubes(&cubes, &alphaModes);
+		if (ModelBaker::readCachedMesh(AssetCache::getInstance()->find(MESH_CACHE_KIND, key), &mesh))
+			return mesh;
+	}
+
+	PlaneIndex planeIndex = ModelBaker::createPlaneIndex(&cubes);
+
+	std::vector<FaceInstance> alignedFaces;
+	std::vector<FaceInstance> rotatedFaces;
+	std::vector<FaceInstance> cubeFaces;
+
+	for (int i = 0; i < (int)cubes.size(); ++i) {
+		Cube* cube = &cubes[i];
+
+		cubeFaces.clear();
+		FaceRenderer::addFaceInstances(cube, &cubeFaces, &alphaModes, false);
+
+		if (!cube->isAxisAligned()) {
+			// Rotated cubes neither cover nor merge with anything
+			rotatedFaces.insert(rotatedFaces.end(), cubeFaces.begin(), cubeFaces.end());
+			continue;
+		}
+
+		for (auto it = cubeFaces.begin(); it != cubeFaces.end(); ++it) {
+			CubeFace::Orientation orientation = (CubeFace::Orientation)(*it).orientation;
+			if (!ModelBaker::isFaceCovered(&cubes, &alphaModes, &planeIndex, i, orientation))
+				alignedFaces.push_back(*it);
+		}
+	}
+
+	ModelBaker::mergeFaces(&alignedFaces);
+	alignedFaces.insert(alignedFaces.end(), rotatedFaces.begin(), rotatedFaces.end());
+
+	// Opaque faces first, they are drawn without alpha testing
+	auto firstCutout = std::stable_partition(alignedFaces.begin(), alignedFaces.end(), [&](const FaceInstance& face) {
+		return FaceRenderer::getAlphaMode(face.textureLayer, &alphaModes) != AlphaMode::CUTOUT;
+	});
+	for (auto it = alignedFaces.begin(); it != firstCutout; ++it) {
+		ModelBaker::appendQuad(&(*it), &mesh);
+	}
+	mesh.firstCutoutIndex = (int)mesh.indices.size();
+	for (auto it = firstCutout; it != alignedFaces.end(); ++it) {
+		ModelBaker::appendQuad(&(*it), &mesh);
+	}
+
+	if (useCache)
+		ModelBaker::storeCachedMesh(key, &mesh);
+
+	return mesh;
+}
+unsigned long long ModelBaker::hashCubes(std::vector<Cube>* cubes, std::vector<AlphaMode>* alphaModes) {
+	unsigned long long hash = AssetCache::hash(&MESH_CACHE_VERSION, sizeof(MESH_CACHE_VERSION));
+
+	// Field by field, padding between them would make the hash unstable
+	for (auto it = cubes->begin(); it != cubes->end(); ++it) {
+		glm::vec3 position = it->getPosition();
+		glm::vec3 size = it->getSize();
+		Rotation rotation = it->getRotation();
+		int axis = (int)rotation.axis;
+
+		hash = AssetCache::hash(&position[0], 3 * sizeof(float), hash);
+		hash = AssetCache::hash(&size[0], 3 * sizeof(float), hash);
+		hash = AssetCache::hash(&rotation.origin[0], 3 * sizeof(float), hash);
+		hash = AssetCache::hash(&axis, sizeof(axis), hash);
+		hash = AssetCache::hash(&rotation.angleDegrees, sizeof(float), hash);
+
+		for (int face = 0; face < 6; ++face) {
+			CubeFace* cubeFace = it->getFace((CubeFace::Orientation)face);
+			int hidden = cubeFace->hidden ? 1 : 0;
+			int alphaMode = (int)FaceRenderer::getAlphaMode(cubeFace->textureLayer, alphaModes);
+
+			hash = AssetCache::hash(&cubeFace->uvBegin[0], 2 * sizeof(float), hash);
+			hash = AssetCache::hash(&cubeFace->uvEnd[0], 2 * sizeof(float), hash);
+			hash = AssetCache::hash(&cubeFace->textureLayer, sizeof(int), hash);
+			hash = AssetCache::hash(&cubeFace->rotation, sizeof(int), hash);
+			hash = AssetCache::hash(&hidden, sizeof(hidden), hash);
+			hash = AssetCache::hash(&alphaMode, sizeof(alphaMode), hash);
+		}
+	}
+	return hash;
+}
+ModelBaker::PlaneIndex ModelBaker::createPlaneIndex(std::vector<Cube>* cubes) {
+	PlaneIndex planeIndex;
+
+	for (int i = 0; i < (int)cubes->size(); ++i) {
+		Cube* cube = &(*cubes)[i];
+		if (!cube->isAxisAligned())
+			continue;
+
+		// Axis aligned cubes span from their position to position + size
+		glm::vec3 minimum = cube->getPosition();
+		glm::vec3 maximum = cube->getPosition() + cube->getSize();
+
+		for (int axis = 0; axis < 3; ++axis) {
+			planeIndex[getPlaneKey(axis, false, minimum[axis])].push_back(i);
+			planeIndex[getPlaneKey(axis, true, maximum[axis])].push_back(i);
+		}
+	}
+
+	return planeIndex;
+}
+bool ModelBaker::isFaceCovered(std::vector<Cube>* cubes, std::vector<AlphaMode>* alphaModes, PlaneIndex* planeIndex, int cubeIndex, CubeFace::Orientation orientation) {
+	Cube* cube = &(*cubes)[cubeIndex];
+	glm::vec3 minimum = cube->getPosition();
+	glm::vec3 maximum = cube->getPosition() + cube->getSize();
+
+	int axis = faceAxis[orientation];
+	bool pointsPositive = facePointsPositive[orientation];
+	float plane = pointsPositive ? maximum[axis] : minimum[axis];
+
+	// A covering cube starts where this face ends, so look for the opposite side in the same plane
+	auto candidates = planeIndex->find(getPlaneKey(axis, !pointsPositive, plane));
+	if (candidates == planeIndex->end())
+		return false;
+
+	for (auto it = candidates->second.begin(); it != candidates->second.end(); ++it) {
+		if (*it == cubeIndex)
+			continue;
+
+		Cube* other = &(*cubes)[*it];
+		// The touching side of the other cube has to be solid, translucent sides let this face show through
+		if (other->getSize()[axis] <= 0.0f || !other->isFaceVisible(oppositeFace[orientation]))
+			continue;
+		if (FaceRenderer::getAlphaMode(other->getFace(oppositeFace[orientation])->textureLayer, alphaModes) == AlphaMode::TRANSLUCENT)
+			continue;
+
+		glm::vec3 otherMinimum = other->getPosition();
+		glm::vec3 otherMaximum = other->getPosition() + other->getSize();
+
+		bool containsFace = true;
+		for (int tangent = 0; tangent < 3; ++tangent) {
+			if (tangent == axis)
+				continue;
+			if (quantize(otherMinimum[tangent]) > quantize(minimum[tangent]) || quantize(otherMaximum[tangent]) < quantize(maximum[tangent]))
+				containsFace = false;
+		}
+
+		if (containsFace)
+			return true;
+	}
+
+	return false;
+}
+void ModelBaker::mergeFaces(std::vector<FaceInstance>* faces) {
+	// Only faces in the same plane that look the same can merge
+	typedef std::tuple<int, long long, unsigned int, int, int> GroupKey;
+	std::map<GroupKey, std::vector<FaceInstance>> groups;
+
+	for (auto it = faces->begin(); it != faces->end(); ++it) {
+		FaceInstance face = *it;
+		// Rotation makes no difference without a texture
+		if (face.textureLayer < 0)
+			face.rotation = 0;
+
+		int axis = faceAxis[face.orientation];
+		GroupKey key = std::make_tuple(face.orientation, quantize(face.origin[axis]), face.color, face.textureLayer, face.rotation);
+		groups[key].push_back(face);
+	}
+
+	faces->clear();
+	for (auto it = groups.begin(); it != groups.end(); ++it) {
+		std::vector<FaceInstance>* group = &it->second;
+
+		// Rotated textures don't continue across faces, so leave those alone
+		bool canMergeGroup = std::get<3>(it->first) < 0 || std::get<4>(it->first) == 0;
+		if (canMergeGroup) {
+			bool merged = true;
+			while (merged) {
+				bool mergedAlongU = ModelBaker::mergeAlong(group, true);
+				bool mergedAlongV = ModelBaker::mergeAlong(group, false);
+				merged = mergedAlongU || mergedAlongV;
+			}
+		}
+
+		faces->insert(faces->end(), group->begin(), group->end());
+	}
+}
+bool ModelBaker::mergeAlong(std::vector<FaceInstance>* faces, bool alongU) {
+	if (faces->size() < 2)
+		return false;
+
+	// All faces in a group share their edge directions
+	glm::vec3 mergeDirection = glm::normalize(alongU ? (*faces)[0].edgeU : (*faces)[0].edgeV);
+	glm::vec3 rowDirection = glm::normalize(alongU ? (*faces)[0].edgeV : (*faces)[0].edgeU);
+
+	// Sort into rows, so faces that can merge end up next to each other
+	std::sort(faces->begin(), faces->end(), [&](const FaceInstance& a, const FaceInstance& b) {
+		long long rowA = quantize(glm::dot(a.origin, rowDirection));
+		long long rowB = quantize(glm::dot(b.origin, rowDirection));
+		if (rowA != rowB)
+			return rowA < rowB;
+		return glm::dot(a.origin, mergeDirection) < glm::dot(b.origin, mergeDirection);
+	});
+
+	std::vector<FaceInstance> result;
+	result.push_back((*faces)[0]);
+	for (int i = 1; i < (int)faces->size(); ++i) {
+		FaceInstance* current = &result.back();
+		FaceInstance* next = &(*faces)[i];
+
+		if (!ModelBaker::canMerge(current, next, alongU)) {
+			result.push_back(*next);
+			continue;
+		}
+
+		if (alongU) {
+			current->edgeU += next->edgeU;
+			current->uvRect.z = next->uvRect.z;
+		} else {
+			current->edgeV += next->edgeV;
+			current->uvRect.w = next->uvRect.w;
+		}
+	}
+
+	bool merged = result.size() < faces->size();
+	faces->swap(result);
+	return merged;
+}
+bool ModelBaker::canMerge(FaceInstance* first, FaceInstance* second, bool alongU) {
+	glm::vec3 firstEdge = alongU ? first->edgeU : first->edgeV;
+	glm::vec3 firstSide = alongU ? first->edgeV : first->edgeU;
+	glm::vec3 secondEdge = alongU ? second->edgeU : second->edgeV;
+	glm::vec3 secondSide = alongU ? second->edgeV : second->edgeU;
+
+	// The second face has to start where the first one ends, with the same side length
+	glm::vec3 firstEnd = first->origin + firstEdge;
+	for (int axis = 0; axis < 3; ++axis) {
+		if (quantize(firstEnd[axis]) != quantize(second->origin[axis]))
+			return false;
+		if (quantize(firstSide[axis]) != quantize(secondSide[axis]))
+			return false;
+	}
+
+	if (first->textureLayer < 0)
+		return true;
+
+	// Textures have to continue seamlessly from one face into the other
+	int along = alongU ? 0 : 1;
+	int across = alongU ? 1 : 0;
+	float firstBegin = first->uvRect[along];
+	float firstFinish = first->uvRect[along + 2];
+	float secondBegin = second->uvRect[along];
+	float secondFinish = second->uvRect[along + 2];
+
+	if (!nearlyEqual(first->uvRect[across], second->uvRect[across]) || !nearlyEqual(first->uvRect[across + 2], second->uvRect[across + 2]))
+		return false;
+	if (!nearlyEqual(firstFinish, secondBegin))
+		return false;
+
+	float firstDensity = (firstFinish - firstBegin) / glm::length(firstEdge);
+	float secondDensity = (secondFinish - secondBegin) / glm::length(secondEdge);
+	return nearlyEqual(firstDensity, secondDensity);
+}
+void ModelBaker::appendQuad(FaceInstance* face, BakedMesh* mesh) {
+	const glm::vec2 corners[4] = {
+		glm::vec2(0.0f, 0.0f),
+		glm::vec2(1.0f, 0.0f),
+		glm::vec2(1.0f, 1.0f),
+		glm::vec2(0.0f, 1.0f)
+	};
+	const unsigned int quadIndices[6] = {
+		3, 0, 1,
+		2, 3, 1
+	};
+
+	unsigned int firstVertex = (unsigned int)mesh->vertices.size();
+	glm::vec2 uvBegin = glm::vec2(face->uvRect.x, face->uvRect.y);
+	glm::vec2 uvEnd = glm::vec2(face->uvRect.z, face->uvRect.w);
+
+	for (int i = 0; i < 4; ++i) {
+		// Same texture rotation as the face shader
+		glm::vec2 textureCorner = corners[i];
+		for (int turn = 0; turn < face->rotation; ++turn) {
+			textureCorner = glm::vec2(textureCorner.y, 1.0f - textureCorner.x);
+		}
+
+		BakedVertex vertex;
+		vertex.position = face->origin + corners[i].x * face->edgeU + corners[i].y * face->edgeV;
+		vertex.texCoord = uvBegin + (uvEnd - uvBegin) * textureCorner;
+		vertex.color = face->color;
+		vertex.textureLayer = face->textureLayer;
+		mesh->vertices.push_back(vertex);
+	}
+
+	for (int i = 0; i < 6; ++i) {
+		mesh->indices.push_back(firstVertex + quadIndices[i]);
+	}
+}
+bool ModelBaker::readCachedMesh(std::shared_ptr<AssetCache::Entry> entry, BakedMesh* mesh) {
+	if (!entry || entry->getPayloadSize() < MESH_HEADER_SIZE)
+		return false;
+
+	const unsigned int* header = (const unsigned int*)entry->getPayload();
+	size_t vertexSize = header[0] * sizeof(BakedVertex);
+	size_t indexSize = header[1] * sizeof(unsigned int);
+	if (MESH_HEADER_SIZE + vertexSize + indexSize != entry->getPayloadSize() || header[2] > header[1])
+		return false;
+
+	const unsigned char* data = entry->getPayload() + MESH_HEADER_SIZE;
+	mesh->vertices.resize(header[0]);
+	mesh->indices.resize(header[1]);
+	mesh->firstCutoutIndex = (int)header[2];
+	std::memcpy(mesh->vertices.data(), data, vertexSize);
+	std::memcpy(mesh->indices.data(), data + vertexSize, indexSize);
+	return true;
+}
+void ModelBaker::storeCachedMesh(unsigned long long key, BakedMesh* mesh) {
+	size_t vertexSize = mesh->vertices.size() * sizeof(BakedVertex);
+	size_t indexSize = mesh->indices.size() * sizeof(unsigned int);
+
+	std::vector<unsigned char> data(MESH_HEADER_SIZE + vertexSize + indexSize);
+	unsigned int header[3] = { (unsigned int)mesh->vertices.size(), (unsigned int)mesh->indices.size(), (unsigned int)mesh->firstCutoutIndex };
+	std::memcpy(data.data(), header, MESH_HEADER_SIZE);
+	std::memcpy(data.data() + MESH_HEADER_SIZE, mesh->vertices.data(), vertexSize);
+	std::memcpy(data.data() + MESH_HEADER_SIZE + vertexSize, mesh->indices.data(), indexSize);
+
+	AssetCache::getInstance()->store(MESH_CACHE_KIND, key, data.data(), data.size());
+}
\ No newline at end of file
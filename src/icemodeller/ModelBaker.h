@@ -0,0 +1,51 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "../gui/Gui.h"
+#include "../import/AssetCache.h"
+#include "Model.h"
+#include "ModelRenderer.h"
+
+struct BakedVertex {
+	glm::vec3 position;
+	glm::vec2 texCoord;
+	unsigned int color;		// RGBA8
+	int textureLayer;		// -1 if untextured
+};
+
+struct BakedMesh {
+	std::vector<BakedVertex> vertices;
+	std::vector<unsigned int> indices;
+	int firstCutoutIndex = 0;	// Faces that need alpha testing come after all opaque ones
+	unsigned int revision = 0;	// Revision of the model this mesh was baked from
+};
+
+class ModelBaker {
+	/*
+		Turns the cubes of a model into one static mesh. Faces covered by a neighbouring cube are dropped
+		and coplanar faces that continue each other are merged into larger quads.
+		Only works on CPU data, so baking can run on a worker thread.
+		Meshes of models that were just opened are kept in the asset cache, keyed by a hash of their cubes.
+		Faces with translucent textures are left out and don't cover anything, the FaceRenderer sorts and draws those.
+		Faces with cutout textures are put at the end, so only that part of the mesh is drawn with alpha testing.
+	*/
+	public:
+		static BakedMesh bake(std::vector<Cube> cubes, std::vector<AlphaMode> alphaModes, unsigned int revision, bool useCache);
+
+		static unsigned long long hashCubes(std::vector<Cube>* cubes, std::vector<AlphaMode>* alphaModes);
+
+	private:
+		// Axis aligned cubes by the planes their sides lie in
+		typedef std::unordered_map<long long, std::vector<int>> PlaneIndex;
+
+		static PlaneIndex createPlaneIndex(std::vector<Cube>* cubes);
+		static bool isFaceCovered(std::vector<Cube>* cubes, std::vector<AlphaMode>* alphaModes, PlaneIndex* planeIndex, int cubeIndex, CubeFace::Orientation orientation);
+		static void mergeFaces(std::vector<FaceInstance>* faces);
+		static bool mergeAlong(std::vector<FaceInstance>* faces, bool alongU);
+		static bool canMerge(FaceInstance* first, FaceInstance* second, bool alongU);
+		static void appendQuad(FaceInstance* face, BakedMesh* mesh);
+
+		static bool readCachedMesh(std::shared_ptr<AssetCache::Entry> entry, BakedMesh* mesh);
+		static void storeCachedMesh(unsigned long long key, BakedMesh* mesh);
+};
\ No newline at end of file
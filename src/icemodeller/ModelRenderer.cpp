@@ -0,0 +1,546 @@
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+#include "ModelRenderer.h"
+#include "ModelBaker.h"
+#include "../render/RadixSort.h"
+
+static const int INITIAL_INSTANCE_CAPACITY = 64;
+static const int QUAD_VERTEX_SIZE = 2 * sizeof(float);
+// Depth keys of translucent faces, two radix passes
+static const int DEPTH_KEY_BITS = 16;
+static const float DEPTH_KEY_MAX = (float)((1 << DEPTH_KEY_BITS) - 1);
+
+// Uniforms of the cube shaders
+static constexpr UniformName TEXTURES_UNIFORM = "textures";
+
+const glm::vec4 defaultCubeFaceColor[6] = {
+	glm::vec4(1.0, 0.0, 0.0, 1.0),	// NORTH	-> RED
+	glm::vec4(0.0, 1.0, 0.0, 1.0),	// EAST		-> GREEN
+	glm::vec4(0.0, 0.0, 1.0, 1.0),	// SOUTH	-> BLUE
+	glm::vec4(1.0, 1.0, 0.0, 1.0),	// WEST		-> YELLOW
+	glm::vec4(1.0, 0.0, 1.0, 1.0),	// UP		-> MAGENTA
+	glm::vec4(0.0, 1.0, 1.0, 1.0),	// DOWN		-> CYAN
+};
+const glm::vec4 texturedCubeFaceColor = glm::vec4(0.0, 0.0, 0.0, 1.0);
+
+// Corners of every face on the unit cube, as origin, end of the u edge and end of the v edge
+const glm::vec3 unitCubeFaceCorners[6][3] = {
+	{ glm::vec3(1.0, 0.0, 0.0), glm::vec3(0.0, 0.0, 0.0), glm::vec3(1.0, 1.0, 0.0) },	// NORTH
+	{ glm::vec3(1.0, 0.0, 1.0), glm::vec3(1.0, 0.0, 0.0), glm::vec3(1.0, 1.0, 1.0) },	// EAST
+	{ glm::vec3(0.0, 0.0, 1.0), glm::vec3(1.0, 0.0, 1.0), glm::vec3(0.0, 1.0, 1.0) },	// SOUTH
+	{ glm::vec3(0.0, 0.0, 0.0), glm::vec3(0.0, 0.0, 1.0), glm::vec3(0.0, 1.0, 0.0) },	// WEST
+	{ glm::vec3(1.0, 1.0, 0.0), glm::vec3(0.0, 1.0, 0.0), glm::vec3(1.0, 1.0, 1.0) },	// UP
+	{ glm::vec3(1.0, 0.0, 1.0), glm::vec3(0.0, 0.0, 1.0), glm::vec3(1.0, 0.0, 0.0) },	// DOWN
+};
+
+// FaceRenderer
+FaceRenderer::FaceRenderer(ShaderVariants* shaders) {
+	this->shaders = shaders;
+	this->instanceCapacity = 0;
+	this->uploadedModel = nullptr;
+	this->lastUploadSize = 0;
+	this->quadVertices = render::BufferArena::INVALID_ALLOCATION;
+	this->quadIndices = render::BufferArena::INVALID_ALLOCATION;
+	this->visibleCapacity = 0;
+	this->visibleInstanceCount = 0;
+	this->visibleInstancesDirty = true;
+	this->drawnInstanceCount = 0;
+	this->alphaModes = nullptr;
+	this->alphaModeRevision = 0;
+	this->translucentCapacity = 0;
+	this->translucentOrderDirty = true;
+
+	this->createUnitQuad();
+
+	this->instanceVBO = render::Buffer::create();
+	this->instanceCapacity = INITIAL_INSTANCE_CAPACITY;
+	FaceRenderer::allocateInstanceBuffer(&this->instanceVBO, this->instanceCapacity);
+
+	this->visibleVBO = render::Buffer::create();
+	this->visibleCapacity = INITIAL_INSTANCE_CAPACITY;
+	FaceRenderer::allocateInstanceBuffer(&this->visibleVBO, this->visibleCapacity);
+
+	this->translucentVBO = render::Buffer::create();
+	this->translucentCapacity = INITIAL_INSTANCE_CAPACITY;
+	FaceRenderer::allocateInstanceBuffer(&this->translucentVBO, this->translucentCapacity);
+
+	this->vao = this->createVertexArray(&this->instanceVBO);
+	this->visibleVAO = this->createVertexArray(&this->visibleVBO);
+	this->translucentVAO = this->createVertexArray(&this->translucentVBO);
+}
+FaceRenderer::~FaceRenderer() {
+	render::BufferArena::getVertexArena()->release(this->quadVertices);
+	render::BufferArena::getIndexArena()->release(this->quadIndices);
+}
+void FaceRenderer::update(Model* model, const std::vector<AlphaMode>* alphaModes, unsigned int alphaModeRevision) {
+	this->lastUploadSize = 0;
+
+	// Faces move between the opaque instances and the translucent ones when a texture turns out to be translucent
+	bool needsRebuild = model != this->uploadedModel || model->hasStructureChanged()
+		|| alphaModes != this->alphaModes || alphaModeRevision != this->alphaModeRevision;
+	if (!needsRebuild && model->getChangedCubes()->empty())
+		return;
+
+	this->alphaModes = alphaModes;
+	this->alphaModeRevision = alphaModeRevision;
+
+	this->visibleInstancesDirty = true;
+	if (needsRebuild || !this->updateChangedCubes(model)) {
+		this->rebuildInstances(model);
+	}
+	this->rebuildTranslucentInstances(model);
+	this->uploadedModel = model;
+}
+void FaceRenderer::submit(render::RenderQueue* queue, std::vector<int>* visibleCubes, unsigned int shaderFeatures, unsigned int texture) {
+	this->drawnInstanceCount = 0;
+	if (this->instances.empty())
+		return;
+
+	render::DrawPayload payload;
+	if ((int)visibleCubes->size() == (int)this->cubeInstanceCount.size()) {
+		// Everything is visible, so draw straight from the instance buffer
+		payload.vertexArray = this->vao.getID();
+		this->drawnInstanceCount = (int)this->instances.size();
+	} else {
+		this->updateVisibleInstances(visibleCubes);
+		payload.vertexArray = this->visibleVAO.getID();
+		this->drawnInstanceCount = this->visibleInstanceCount;
+	}
+
+	if (this->drawnInstanceCount == 0)
+		return;
+
+	int baseVertex = render::BufferArena::getVertexArena()->getOffset(this->quadVertices) / QUAD_VERTEX_SIZE;
+	intptr_t indexOffset = render::BufferArena::getIndexArena()->getOffset(this->quadIndices);
+	int instanceCount = this->drawnInstanceCount;
+	bool isTextured = (shaderFeatures & SHADER_TEXTURED) != 0;
+
+	payload.shader = this->shaders->get(shaderFeatures | SHADER_INSTANCED);
+	if (isTextured) {
+		payload.textureTarget = GL_TEXTURE_2D_ARRAY;
+		payload.texture = texture;
+	}
+	payload.draw = [baseVertex, indexOffset, instanceCount, isTextured](Shader* shader) {
+		if (isTextured)
+			shader->setInt(TEXTURES_UNIFORM, 0);
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)indexOffset, (GLsizei)instanceCount, baseVertex);
+	};
+
+	render::RenderLayer layer = (shaderFeatures & SHADER_ALPHA_TESTED) ? render::RenderLayer::CUTOUT : render::RenderLayer::OPAQUE;
+	queue->submit(render::RenderQueue::makeKey(layer, payload.shader->program.getID(), payload.texture, 0.0f), std::move(payload));
+}
+int FaceRenderer::getLastUploadSize() {
+	return this->lastUploadSize;
+}
+void FaceRenderer::submitTranslucent(render::RenderQueue* queue, glm::mat4 viewMatrix, unsigned int shaderFeatures, unsigned int texture) {
+	if (this->translucentInstances.empty())
+		return;
+
+	if (this->translucentOrderDirty || viewMatrix != this->sortedViewMatrix)
+		this->sortTranslucentInstances(viewMatrix);
+
+	int baseVertex = render::BufferArena::getVertexArena()->getOffset(this->quadVertices) / QUAD_VERTEX_SIZE;
+	intptr_t indexOffset = render::BufferArena::getIndexArena()->getOffset(this->quadIndices);
+	int instanceCount = (int)this->sortedInstances.size();
+	bool isTextured = (shaderFeatures & SHADER_TEXTURED) != 0;
+
+	// Blended instead of alpha tested, which would discard the faint parts
+	render::DrawPayload payload;
+	payload.shader = this->shaders->get((shaderFeatures & ~SHADER_ALPHA_TESTED) | SHADER_INSTANCED);
+	payload.vertexArray = this->translucentVAO.getID();
+	if (isTextured) {
+		payload.textureTarget = GL_TEXTURE_2D_ARRAY;
+		payload.texture = texture;
+	}
+	payload.draw = [baseVertex, indexOffset, instanceCount, isTextured](Shader* shader) {
+		if (isTextured)
+			shader->setInt(TEXTURES_UNIFORM, 0);
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)indexOffset, (GLsizei)instanceCount, baseVertex);
+	};
+
+	queue->submit(render::RenderQueue::makeKey(render::RenderLayer::TRANSLUCENT, payload.shader->program.getID(), payload.texture, 0.0f), std::move(payload));
+}
+int FaceRenderer::getDrawnInstanceCount() {
+	return this->drawnInstanceCount;
+}
+int FaceRenderer::getTranslucentInstanceCount() {
+	return (int)this->translucentInstances.size();
+}
+AlphaMode FaceRenderer::getAlphaMode(int textureLayer, const std::vector<AlphaMode>* alphaModes) {
+	if (alphaModes == nullptr || textureLayer < 0 || textureLayer >= (int)alphaModes->size())
+		return AlphaMode::OPAQUE;
+	return (*alphaModes)[textureLayer];
+}
+void FaceRenderer::addFaceInstances(Cube* cube, std::vector<FaceInstance>* instances, const std::vector<AlphaMode>* alphaModes, bool translucent) {
+	glm::mat4 modelMatrix = cube->getModelMatrix();
+	glm::vec3 size = cube->getSize();
+
+	for (int face = 0; face < 6; ++face) {
+		CubeFace::Orientation orientation = (CubeFace::Orientation) face;
+		if (!cube->isFaceVisible(orientation))
+			continue;
+
+		CubeFace* cubeFace = cube->getFace(orientation);
+		bool isTranslucent = FaceRenderer::getAlphaMode(cubeFace->textureLayer, alphaModes) == AlphaMode::TRANSLUCENT;
+		if (isTranslucent != translucent)
+			continue;
+
+		// Transform corners of the unit cube to world space
+		glm::vec3 corners[3];
+		for (int i = 0; i < 3; ++i) {
+			glm::vec3 cubePosition = unitCubeFaceCorners[face][i] * size - glm::vec3(0.5f);
+			corners[i] = glm::vec3(modelMatrix * glm::vec4(cubePosition, 1.0f));
+		}
+
+		FaceInstance instance;
+		instance.origin = corners[0];
+		instance.edgeU = corners[1] - corners[0];
+		instance.edgeV = corners[2] - corners[0];
+		instance.uvRect = glm::vec4(cubeFace->uvBegin.x, cubeFace->uvBegin.y, cubeFace->uvEnd.x, cubeFace->uvEnd.y);
+		instance.textureLayer = cubeFace->textureLayer;
+		instance.orientation = face;
+		instance.rotation = ((cubeFace->rotation / 90) % 4 + 4) % 4;
+
+		if (cubeFace->textureLayer >= 0) {
+			instance.color = FaceRenderer::packColor(texturedCubeFaceColor);
+		} else {
+			instance.color = FaceRenderer::packColor(defaultCubeFaceColor[face]);
+		}
+
+		instances->push_back(instance);
+	}
+}
+void FaceRenderer::createUnitQuad() {
+	// Quad corners double as texture coordinates
+	const float vertices[] = {
+		0.0f, 0.0f,
+		1.0f, 0.0f,
+		1.0f, 1.0f,
+		0.0f, 1.0f,
+	};
+	const unsigned int indices[] = {
+		3, 0, 1,
+		2, 3, 1,
+	};
+
+	render::BufferArena* vertexArena = render::BufferArena::getVertexArena();
+	this->quadVertices = vertexArena->allocate(sizeof(vertices), QUAD_VERTEX_SIZE);
+	vertexArena->upload(this->quadVertices, vertices, sizeof(vertices));
+
+	render::BufferArena* indexArena = render::BufferArena::getIndexArena();
+	this->quadIndices = indexArena->allocate(sizeof(indices), sizeof(unsigned int));
+	indexArena->upload(this->quadIndices, indices, sizeof(indices));
+}
+void FaceRenderer::allocateInstanceBuffer(render::Buffer* buffer, int capacity) {
+	glBindBuffer(GL_ARRAY_BUFFER, buffer->getID());
+	glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(FaceInstance), nullptr, GL_DYNAMIC_DRAW);
+}
+render::VertexArray FaceRenderer::createVertexArray(render::Buffer* instanceBuffer) {
+	render::VertexArray vertexArray = render::VertexArray::create();
+	vertexArray.bind();
+
+	glBindBuffer(GL_ARRAY_BUFFER, render::BufferArena::getVertexArena()->getBufferID());
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, render::BufferArena::getIndexArena()->getBufferID());
+
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, QUAD_VERTEX_SIZE, (void*)0);
+	glEnableVertexAttribArray(0);
+
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer->getID());
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(FaceInstance), (void*)offsetof(FaceInstance, origin));
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(FaceInstance), (void*)offsetof(FaceInstance, edgeU));
+	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(FaceInstance), (void*)offsetof(FaceInstance, edgeV));
+	glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(FaceInstance), (void*)offsetof(FaceInstance, uvRect));
+	glVertexAttribIPointer(5, 1, GL_UNSIGNED_INT, sizeof(FaceInstance), (void*)offsetof(FaceInstance, color));
+	// Texture layer, orientation and rotation share one attribute
+	glVertexAttribIPointer(6, 3, GL_INT, sizeof(FaceInstance), (void*)offsetof(FaceInstance, textureLayer));
+
+	for (GLuint location = 1; location <= 6; ++location) {
+		glEnableVertexAttribArray(location);
+		glVertexAttribDivisor(location, 1);
+	}
+
+	render::GlState::getInstance()->bindVertexArray(0);
+	return vertexArray;
+}
+void FaceRenderer::rebuildInstances(Model* model) {
+	std::vector<Cube>* cubes = model->getCubes();
+
+	this->instances.clear();
+	this->cubeFirstInstance.clear();
+	this->cubeInstanceCount.clear();
+
+	for (auto it = cubes->begin(); it != cubes->end(); ++it) {
+		int firstInstance = (int)this->instances.size();
+		FaceRenderer::addFaceInstances(&(*it), &this->instances, this->alphaModes, false);
+
+		this->cubeFirstInstance.push_back(firstInstance);
+		this->cubeInstanceCount.push_back((int)this->instances.size() - firstInstance);
+	}
+
+	this->uploadInstances();
+}
+bool FaceRenderer::updateChangedCubes(Model* model) {
+	std::vector<Cube>* cubes = model->getCubes();
+	std::vector<int> changedCubes = *model->getChangedCubes();
+	std::sort(changedCubes.begin(), changedCubes.end());
+
+	std::vector<FaceInstance> cubeInstances;
+	for (auto it = changedCubes.begin(); it != changedCubes.end(); ++it) {
+		cubeInstances.clear();
+		FaceRenderer::addFaceInstances(&(*cubes)[*it], &cubeInstances, this->alphaModes, false);
+
+		// A face appeared or disappeared, so the slices after this cube shift
+		if ((int)cubeInstances.size() != this->cubeInstanceCount[*it])
+			return false;
+
+		std::copy(cubeInstances.begin(), cubeInstances.end(), this->instances.begin() + this->cubeFirstInstance[*it]);
+	}
+
+	// Upload neighbouring cubes together
+	int rangeFirst = -1;
+	int rangeEnd = -1;
+	for (auto it = changedCubes.begin(); it != changedCubes.end(); ++it) {
+		int first = this->cubeFirstInstance[*it];
+		int end = first + this->cubeInstanceCount[*it];
+
+		if (first != rangeEnd) {
+			this->uploadInstanceRange(rangeFirst, rangeEnd - rangeFirst);
+			rangeFirst = first;
+		}
+		rangeEnd = end;
+	}
+	this->uploadInstanceRange(rangeFirst, rangeEnd - rangeFirst);
+
+	return true;
+}
+void FaceRenderer::uploadInstances() {
+	int instanceCount = (int)this->instances.size();
+	glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO.getID());
+
+	if (instanceCount > this->instanceCapacity) {
+		// Grow geometrically so adding cubes one by one doesn't reallocate every time
+		while (this->instanceCapacity < instanceCount)
+			this->instanceCapacity *= 2;
+		FaceRenderer::allocateInstanceBuffer(&this->instanceVBO, this->instanceCapacity);
+	}
+	this->uploadInstanceRange(0, instanceCount);
+}
+void FaceRenderer::updateVisibleInstances(std::vector<int>* visibleCubes) {
+	if (!this->visibleInstancesDirty && *visibleCubes == this->visibleCubes)
+		return;
+
+	this->visibleCubes = *visibleCubes;
+	this->visibleInstancesDirty = false;
+
+	int instanceCount = 0;
+	for (auto it = visibleCubes->begin(); it != visibleCubes->end(); ++it) {
+		instanceCount += this->cubeInstanceCount[*it];
+	}
+	this->visibleInstanceCount = instanceCount;
+
+	if (instanceCount > this->visibleCapacity) {
+		while (this->visibleCapacity < instanceCount)
+			this->visibleCapacity *= 2;
+		FaceRenderer::allocateInstanceBuffer(&this->visibleVBO, this->visibleCapacity);
+	}
+
+	// Instances stay on the GPU, visible slices are copied next to each other
+	glBindBuffer(GL_COPY_READ_BUFFER, this->instanceVBO.getID());
+	glBindBuffer(GL_COPY_WRITE_BUFFER, this->visibleVBO.getID());
+
+	int rangeFirst = 0;
+	int rangeEnd = 0;
+	int destination = 0;
+	for (auto it = visibleCubes->begin(); it != visibleCubes->end(); ++it) {
+		int first = this->cubeFirstInstance[*it];
+		int end = first + this->cubeInstanceCount[*it];
+
+		if (first != rangeEnd) {
+			destination += this->copyInstanceRange(rangeFirst, rangeEnd - rangeFirst, destination);
+			rangeFirst = first;
+		}
+		rangeEnd = end;
+	}
+	this->copyInstanceRange(rangeFirst, rangeEnd - rangeFirst, destination);
+}
+int FaceRenderer::copyInstanceRange(int first, int count, int destination) {
+	if (count <= 0)
+		return 0;
+
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, first * sizeof(FaceInstance), destination * sizeof(FaceInstance), count * sizeof(FaceInstance));
+	return count;
+}
+void FaceRenderer::rebuildTranslucentInstances(Model* model) {
+	this->translucentInstances.clear();
+	this->translucentOrderDirty = true;
+
+	// Most models have no translucent textures at all
+	if (this->alphaModes == nullptr || std::find(this->alphaModes->begin(), this->alphaModes->end(), AlphaMode::TRANSLUCENT) == this->alphaModes->end())
+		return;
+
+	std::vector<Cube>* cubes = model->getCubes();
+	for (auto it = cubes->begin(); it != cubes->end(); ++it) {
+		FaceRenderer::addFaceInstances(&(*it), &this->translucentInstances, this->alphaModes, true);
+	}
+}
+void FaceRenderer::sortTranslucentInstances(glm::mat4 viewMatrix) {
+	this->sortedViewMatrix = viewMatrix;
+	this->translucentOrderDirty = false;
+
+	int instanceCount = (int)this->translucentInstances.size();
+
+	// Only the depth row of the view matrix is needed
+	glm::vec3 depthRow = glm::vec3(viewMatrix[0][2], viewMatrix[1][2], viewMatrix[2][2]);
+	float depthOffset = viewMatrix[3][2];
+
+	std::vector<float> depths(instanceCount);
+	float minimumDepth = 0.0f;
+	float maximumDepth = 0.0f;
+	for (int i = 0; i < instanceCount; ++i) {
+		FaceInstance* instance = &this->translucentInstances[i];
+		glm::vec3 center = instance->origin + 0.5f * (instance->edgeU + instance->edgeV);
+		depths[i] = -(glm::dot(depthRow, center) + depthOffset);
+
+		minimumDepth = i == 0 ? depths[i] : std::min(minimumDepth, depths[i]);
+		maximumDepth = i == 0 ? depths[i] : std::max(maximumDepth, depths[i]);
+	}
+
+	// Quantized over the range the faces span, so nearby faces keep distinct keys
+	float scale = maximumDepth > minimumDepth ? DEPTH_KEY_MAX / (maximumDepth - minimumDepth) : 0.0f;
+	this->depthKeys.resize(instanceCount);
+	for (int i = 0; i < instanceCount; ++i) {
+		this->depthKeys[i].depth = (unsigned int)((maximumDepth - depths[i]) * scale);
+		this->depthKeys[i].instance = i;
+	}
+
+	render::radixSort(&this->depthKeys, &this->depthKeyBuffer, DEPTH_KEY_BITS, [](const DepthKey& key) {
+		return key.depth;
+	});
+
+	this->sortedInstances.resize(instanceCount);
+	for (int i = 0; i < instanceCount; ++i) {
+		this->sortedInstances[i] = this->translucentInstances[this->depthKeys[i].instance];
+	}
+
+	// Orphaned first, so writing doesn't wait for the previous frame to finish drawing
+	while (this->translucentCapacity < instanceCount)
+		this->translucentCapacity *= 2;
+	FaceRenderer::allocateInstanceBuffer(&this->translucentVBO, this->translucentCapacity);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, instanceCount * sizeof(FaceInstance), this->sortedInstances.data());
+	this->lastUploadSize += instanceCount * (int)sizeof(FaceInstance);
+}
+void FaceRenderer::uploadInstanceRange(int first, int count) {
+	if (count <= 0)
+		return;
+
+	glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO.getID());
+	glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(FaceInstance), count * sizeof(FaceInstance), &this->instances[first]);
+	this->lastUploadSize += count * (int)sizeof(FaceInstance);
+}
+unsigned int FaceRenderer::packColor(glm::vec4 color) {
+	unsigned int r = (unsigned int)(glm::clamp(color.x, 0.0f, 1.0f) * 255.0f + 0.5f);
+	unsigned int g = (unsigned int)(glm::clamp(color.y, 0.0f, 1.0f) * 255.0f + 0.5f);
+	unsigned int b = (unsigned int)(glm::clamp(color.z, 0.0f, 1.0f) * 255.0f + 0.5f);
+	unsigned int a = (unsigned int)(glm::clamp(color.w, 0.0f, 1.0f) * 255.0f + 0.5f);
+	return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+// BakedMeshRenderer
+BakedMeshRenderer::BakedMeshRenderer(ShaderVariants* shaders) {
+	this->shaders = shaders;
+	this->indexCount = 0;
+	this->firstCutoutIndex = 0;
+	this->hasMesh = false;
+	this->revision = 0;
+	this->vertexAllocation = render::BufferArena::INVALID_ALLOCATION;
+	this->indexAllocation = render::BufferArena::INVALID_ALLOCATION;
+
+	this->vao = render::VertexArray::create();
+	this->vao.bind();
+
+	glBindBuffer(GL_ARRAY_BUFFER, render::BufferArena::getVertexArena()->getBufferID());
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, render::BufferArena::getIndexArena()->getBufferID());
+
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(BakedVertex), (void*)offsetof(BakedVertex, position));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(BakedVertex), (void*)offsetof(BakedVertex, texCoord));
+	glEnableVertexAttribArray(1);
+	glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(BakedVertex), (void*)offsetof(BakedVertex, color));
+	glEnableVertexAttribArray(2);
+	glVertexAttribIPointer(3, 1, GL_INT, sizeof(BakedVertex), (void*)offsetof(BakedVertex, textureLayer));
+	glEnableVertexAttribArray(3);
+
+	render::GlState::getInstance()->bindVertexArray(0);
+}
+BakedMeshRenderer::~BakedMeshRenderer() {
+	this->clear();
+}
+void BakedMeshRenderer::upload(BakedMesh* mesh) {
+	this->clear();
+
+	if (!mesh->indices.empty()) {
+		int vertexSize = (int)(mesh->vertices.size() * sizeof(BakedVertex));
+		int indexSize = (int)(mesh->indices.size() * sizeof(unsigned int));
+
+		render::BufferArena* vertexArena = render::BufferArena::getVertexArena();
+		this->vertexAllocation = vertexArena->allocate(vertexSize, sizeof(BakedVertex));
+		vertexArena->upload(this->vertexAllocation, &mesh->vertices[0], vertexSize);
+
+		render::BufferArena* indexArena = render::BufferArena::getIndexArena();
+		this->indexAllocation = indexArena->allocate(indexSize, sizeof(unsigned int));
+		indexArena->upload(this->indexAllocation, &mesh->indices[0], indexSize);
+	}
+
+	this->indexCount = (int)mesh->indices.size();
+	this->firstCutoutIndex = mesh->firstCutoutIndex;
+	this->revision = mesh->revision;
+	this->hasMesh = true;
+}
+void BakedMeshRenderer::clear() {
+	render::BufferArena::getVertexArena()->release(this->vertexAllocation);
+	render::BufferArena::getIndexArena()->release(this->indexAllocation);
+	this->vertexAllocation = render::BufferArena::INVALID_ALLOCATION;
+	this->indexAllocation = render::BufferArena::INVALID_ALLOCATION;
+
+	this->hasMesh = false;
+	this->indexCount = 0;
+	this->firstCutoutIndex = 0;
+}
+void BakedMeshRenderer::submit(render::RenderQueue* queue, unsigned int shaderFeatures, unsigned int texture) {
+	if (!this->hasMesh || this->indexCount == 0)
+		return;
+
+	// Discarding fragments keeps the GPU from rejecting hidden ones early, so only cutout faces pay for it
+	this->submitRange(queue, 0, this->firstCutoutIndex, render::RenderLayer::OPAQUE, shaderFeatures & ~SHADER_ALPHA_TESTED, texture);
+	render::RenderLayer cutoutLayer = (shaderFeatures & SHADER_ALPHA_TESTED) ? render::RenderLayer::CUTOUT : render::RenderLayer::OPAQUE;
+	this->submitRange(queue, this->firstCutoutIndex, this->indexCount - this->firstCutoutIndex, cutoutLayer, shaderFeatures, texture);
+}
+bool BakedMeshRenderer::isUpToDate(unsigned int modelRevision) {
+	return this->hasMesh && this->revision == modelRevision;
+}
+void BakedMeshRenderer::submitRange(render::RenderQueue* queue, int firstIndex, int indexCount, render::RenderLayer layer, unsigned int shaderFeatures, unsigned int texture) {
+	if (indexCount == 0)
+		return;
+
+	int baseVertex = render::BufferArena::getVertexArena()->getOffset(this->vertexAllocation) / sizeof(BakedVertex);
+	intptr_t indexOffset = render::BufferArena::getIndexArena()->getOffset(this->indexAllocation) + firstIndex * sizeof(unsigned int);
+	bool isTextured = (shaderFeatures & SHADER_TEXTURED) != 0;
+
+	render::DrawPayload payload;
+	payload.shader = this->shaders->get(shaderFeatures);
+	payload.vertexArray = this->vao.getID();
+	if (isTextured) {
+		payload.textureTarget = GL_TEXTURE_2D_ARRAY;
+		payload.texture = texture;
+	}
+	payload.draw = [baseVertex, indexOffset, indexCount, isTextured](Shader* shader) {
+		if (isTextured)
+			shader->setInt(TEXTURES_UNIFORM, 0);
+		glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, (void*)indexOffset, baseVertex);
+	};
+
+	queue->submit(render::RenderQueue::makeKey(layer, payload.shader->program.getID(), payload.texture, 0.0f), std::move(payload));
+}
\ No newline at end of file
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "../gui/Gui.h"
+#include "../render/RenderQueue.h"
+#include "Model.h"
+
+// Per-instance data of a single visible cube face, laid out as it is stored in the instance buffer
+struct FaceInstance {
+	glm::vec3 origin;		// World position of the corner at texture coordinate (0, 0)
+	glm::vec3 edgeU;		// World space edge towards texture coordinate (1, 0)
+	glm::vec3 edgeV;		// World space edge towards texture coordinate (0, 1)
+	glm::vec4 uvRect;		// uvBegin in xy, uvEnd in zw
+	unsigned int color;		// RGBA8
+	int textureLayer;		// -1 if untextured
+	int orientation;		// CubeFace::Orientation
+	int rotation;			// Texture rotation in quarter turns
+};
+
+class FaceRenderer {
+	/*
+		Draws all visible cube faces of a model with a single instanced draw call.
+		Instances of every cube occupy their own slice of the instance buffer, so edited cubes are updated in place.
+		Slices of culled cubes are left out by copying the visible ones into a second buffer on the GPU.
+		Faces with translucent textures are kept apart and drawn after everything else, sorted from back to front.
+	*/
+	public:
+		FaceRenderer(ShaderVariants* shaders);
+		~FaceRenderer();
+
+		// Brings the instance buffer up to date with the changes the model recorded since the previous frame.
+		// Alpha modes are from the TextureRegistry, a new alpha mode revision sorts all faces again
+		void update(Model* model, const std::vector<AlphaMode>* alphaModes, unsigned int alphaModeRevision);
+		// Only instances of the given cubes are drawn, which have to be in ascending order.
+		// The camera comes from the bound render::FrameUniforms, texture is the texture array of the faces
+		void submit(render::RenderQueue* queue, std::vector<int>* visibleCubes, unsigned int shaderFeatures, unsigned int texture);
+		// Translucent faces are sorted by their depth in the view whenever it changes, and drawn in a single call
+		void submitTranslucent(render::RenderQueue* queue, glm::mat4 viewMatrix, unsigned int shaderFeatures, unsigned int texture);
+
+		int getLastUploadSize();
+		int getDrawnInstanceCount();
+		int getTranslucentInstanceCount();
+
+		// Only adds the faces that are translucent or only the ones that aren't, alphaModes may be null
+		static void addFaceInstances(Cube* cube, std::vector<FaceInstance>* instances, const std::vector<AlphaMode>* alphaModes, bool translucent);
+		// Untextured faces are opaque
+		static AlphaMode getAlphaMode(int textureLayer, const std::vector<AlphaMode>* alphaModes);
+		static unsigned int packColor(glm::vec4 color);
+
+	private:
+		ShaderVariants* shaders;
+
+		render::VertexArray vao;
+		int quadVertices;		// Allocations in the shared arenas
+		int quadIndices;
+		render::Buffer instanceVBO;
+		int instanceCapacity;
+
+		// Instances of the visible cubes, packed together when part of the model is culled
+		render::VertexArray visibleVAO;
+		render::Buffer visibleVBO;
+		int visibleCapacity;
+		std::vector<int> visibleCubes;
+		int visibleInstanceCount;
+		bool visibleInstancesDirty;
+		int drawnInstanceCount;
+
+		std::vector<FaceInstance> instances;
+		Model* uploadedModel;
+		std::vector<int> cubeFirstInstance;
+		std::vector<int> cubeInstanceCount;
+		int lastUploadSize;
+		const std::vector<AlphaMode>* alphaModes;
+		unsigned int alphaModeRevision;
+
+		// Translucent faces of all cubes, uploaded in back to front order
+		struct DepthKey {
+			unsigned int depth;		// Quantized, farthest first
+			int instance;
+		};
+		std::vector<FaceInstance> translucentInstances;
+		std::vector<FaceInstance> sortedInstances;
+		std::vector<DepthKey> depthKeys;
+		std::vector<DepthKey> depthKeyBuffer;
+		render::VertexArray translucentVAO;
+		render::Buffer translucentVBO;
+		int translucentCapacity;
+		glm::mat4 sortedViewMatrix;
+		bool translucentOrderDirty;
+
+		void createUnitQuad();
+		render::VertexArray createVertexArray(render::Buffer* instanceBuffer);
+		void rebuildInstances(Model* model);
+		bool updateChangedCubes(Model* model);
+		void uploadInstances();
+		void uploadInstanceRange(int first, int count);
+		void rebuildTranslucentInstances(Model* model);
+		void sortTranslucentInstances(glm::mat4 viewMatrix);
+		void updateVisibleInstances(std::vector<int>* visibleCubes);
+		int copyInstanceRange(int first, int count, int destination);
+
+		static void allocateInstanceBuffer(render::Buffer* buffer, int capacity);
+};
+
+struct BakedMesh;
+
+class BakedMeshRenderer {
+	/*
+		Draws a mesh baked by the ModelBaker with a single draw call
+	*/
+	public:
+		BakedMeshRenderer(ShaderVariants* shaders);
+		~BakedMeshRenderer();
+
+		void upload(BakedMesh* mesh);
+		void clear();
+		// The camera comes from the bound render::FrameUniforms, texture is the texture array of the faces.
+		// Opaque faces are never alpha tested, cutout faces only when shaderFeatures asks for it
+		void submit(render::RenderQueue* queue, unsigned int shaderFeatures, unsigned int texture);
+
+		bool isUpToDate(unsigned int modelRevision);
+
+	private:
+		ShaderVariants* shaders;
+
+		render::VertexArray vao;
+		int vertexAllocation;	// Allocations in the shared arenas
+		int indexAllocation;
+		int indexCount;
+		int firstCutoutIndex;
+
+		bool hasMesh;
+		unsigned int revision;
+
+		void submitRange(render::RenderQueue* queue, int firstIndex, int indexCount, render::RenderLayer layer, unsigned int shaderFeatures, unsigned int texture);
+};
\ No newline at end of file
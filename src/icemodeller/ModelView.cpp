@@ -11,20 +11,47 @@ const float CAMERA_MAX_YAW = 360.0f;
 const float CAMERA_MAX_PITCH = 89.0f;
 const float CAMERA_MIN_PITCH = -89.0f;
 
-unsigned int gridVAO;
-
-const glm::vec4 defaultCubeFaceColor[6] = {
-	glm::vec4(1.0, 0.0, 0.0, 1.0),	// NORTH	-> RED
-	glm::vec4(0.0, 1.0, 0.0, 1.0),	// EAST		-> GREEN
-	glm::vec4(0.0, 0.0, 1.0, 1.0),	// SOUTH	-> BLUE
-	glm::vec4(1.0, 1.0, 0.0, 1.0),	// WEST		-> YELLOW
-	glm::vec4(1.0, 0.0, 1.0, 1.0),	// UP		-> MAGENTA
-	glm::vec4(0.0, 1.0, 1.0, 1.0),	// DOWN		-> CYAN
-};
+static const int GRID_VERTEX_SIZE = 3 * sizeof(float);
+// The grid vertices start with the three axes, followed by 16 lines in each direction
+static const int AXIS_VERTEX_COUNT = 6;
+static const int GRID_LINE_VERTEX_COUNT = 2 * 2 * 16;
+render::VertexArray gridVAO;
+int gridAllocation = render::BufferArena::INVALID_ALLOCATION;
+// The unit cube outline is stored behind the grid lines
+static const int CUBE_OUTLINE_FIRST_VERTEX = AXIS_VERTEX_COUNT + GRID_LINE_VERTEX_COUNT;
+static const int CUBE_OUTLINE_VERTEX_COUNT = 24;
+
+// Uniforms of the gui and line shaders
+static constexpr UniformName TRANSFORMATION_UNIFORM = "transformation";
+static constexpr UniformName COLOR_UNIFORM = "color";
+static constexpr UniformName MODEL_MATRIX_UNIFORM = "modelMatrix";
+static constexpr UniformName TEXEL_SIZE_UNIFORM = "texelSize";
+
+// Mouse movement in pixels below which a release counts as a click instead of a marquee
+const float CLICK_DISTANCE = 4.0f;
+// Smallest marquee extent in panel coordinates, a thinner marquee would give a degenerate frustum
+const float MIN_MARQUEE_SIZE = 0.0001f;
+// Outlines are grown slightly so they are not hidden by the faces of the cube
+const float OUTLINE_MARGIN = 0.005f;
+const glm::vec4 HOVER_COLOR = glm::vec4(1.0, 1.0, 1.0, 1.0);
+const glm::vec4 SELECTION_COLOR = glm::vec4(1.0, 0.8, 0.0, 1.0);
+const glm::vec4 MARQUEE_COLOR = glm::vec4(0.3, 0.5, 1.0, 0.25);
+
+// Time without edits before the model is baked into a static mesh
+const double BAKE_SETTLE_TIME = 0.5;
+// Held camera keys move the camera this often, however often frames are drawn
+const double CAMERA_STEP_TIME = 1.0 / 60.0;
+// Steps caught up on at most after a stall, the rest of the missed time is dropped instead of jumping the camera
+const int MAX_CAMERA_STEPS = 15;
+// Shaders compiling in the driver and meshes baking on a worker can't wake up the main loop, so they are checked this often
+const double BACKGROUND_POLL_INTERVAL = 0.05;
 
 const glm::vec3 WORLD_UP = glm::normalize(glm::vec3(0.0, 1.0, 0.0));
-Shader* cubeShader;
+// Instanced faces and baked meshes share their shader files
+ShaderVariants* cubeShaders;
 Shader* lineShader;
+// Smooths the edges of the drawn viewport, only compiled once a panel uses it
+Shader* fxaaShader = nullptr;
 Shader* testShader;
 
 void initialiseModelView() {
@@ -35,16 +62,27 @@ void initialiseModelView() {
 	if (!gui::Gui::isInitialised())
 		throw NotInitializedException();
 
+	Shader::setUniformBlockBinding(render::FrameUniforms::BLOCK_NAME, render::FrameUniforms::BINDING_POINT);
 	lineShader = new Shader("resources/shaders/lineVertex.vs", "resources/shaders/lineFragment.fs");
-	cubeShader = new Shader("resources/shaders/cubeVertex.vs", "resources/shaders/cubeFragment.fs");
-	testShader = new Shader("resources/shaders/testVertex.vs", "resources/shaders/testFragment.fs");
-
-	gridVAO = createGridVAO();
+	cubeShaders = new ShaderVariants("resources/shaders/cubeVertex.vs", "resources/shaders/cubeFragment.fs");
+	cubeShaders->prepare(0);
+	cubeShaders->prepare(SHADER_INSTANCED);
+	// Only needed once textures are loaded, or not at all, so they don't delay the first frame
+	gui::Gui::mainWindow->runAfterFrame([] {
+		cubeShaders->prepare(SHADER_TEXTURED);
+		cubeShaders->prepare(SHADER_TEXTURED | SHADER_INSTANCED);
+		// Only for textures with fully transparent pixels
+		cubeShaders->prepare(SHADER_TEXTURED | SHADER_ALPHA_TESTED);
+		cubeShaders->prepare(SHADER_TEXTURED | SHADER_ALPHA_TESTED | SHADER_INSTANCED);
+		testShader = new Shader("resources/shaders/testVertex.vs", "resources/shaders/testFragment.fs");
+	});
+
+	createGridVAO();
 
 	modelViewIsInitialised = true;
 }
 
-unsigned int createGridVAO() {
+void createGridVAO() {
 	float vertices[] = {
 		0.0f, 0.0f, 0.0f,	16.0f, 0.0f, 0.0f,	// East pointer (red)
 		0.0f, 0.0f, 0.0f,	0.0f, 16.0f, 0.0f,	// Up pointer (green)
@@ -85,21 +123,32 @@ unsigned int createGridVAO() {
 		14.0f, 0.0f, 0.0f,	14.0f, 0.0f, 16.0f,
 		15.0f, 0.0f, 0.0f,	15.0f, 0.0f, 16.0f,
 		16.0f, 0.0f, 0.0f,	16.0f, 0.0f, 16.0f,
+
+		// Unit cube outline
+		0.0f, 0.0f, 0.0f,	1.0f, 0.0f, 0.0f,
+		1.0f, 0.0f, 0.0f,	1.0f, 0.0f, 1.0f,
+		1.0f, 0.0f, 1.0f,	0.0f, 0.0f, 1.0f,
+		0.0f, 0.0f, 1.0f,	0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f,	1.0f, 1.0f, 0.0f,
+		1.0f, 1.0f, 0.0f,	1.0f, 1.0f, 1.0f,
+		1.0f, 1.0f, 1.0f,	0.0f, 1.0f, 1.0f,
+		0.0f, 1.0f, 1.0f,	0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 0.0f,	0.0f, 1.0f, 0.0f,
+		1.0f, 0.0f, 0.0f,	1.0f, 1.0f, 0.0f,
+		1.0f, 0.0f, 1.0f,	1.0f, 1.0f, 1.0f,
+		0.0f, 0.0f, 1.0f,	0.0f, 1.0f, 1.0f,
 	};
 
-	unsigned int VAO;
-	glGenVertexArrays(1, &VAO);
-	glBindVertexArray(VAO);
+	render::BufferArena* vertexArena = render::BufferArena::getVertexArena();
+	gridAllocation = vertexArena->allocate(sizeof(vertices), GRID_VERTEX_SIZE);
+	vertexArena->upload(gridAllocation, vertices, sizeof(vertices));
 
-	unsigned int VBO;
-	glGenBuffers(1, &VBO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	gridVAO = render::VertexArray::create();
+	gridVAO.bind();
+	glBindBuffer(GL_ARRAY_BUFFER, vertexArena->getBufferID());
 
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, GRID_VERTEX_SIZE, (void*)0);
 	glEnableVertexAttribArray(0);
-
-	return VAO;
 }
 
 /*
@@ -169,10 +218,13 @@ Camera::Camera() {
 	this->yaw = -90.0f;
 	this->pitch = 0.0f;
 	this->fieldOfView = 90.0f;
-	this->movementSpeed = 0.1f;
-	this->rotationSpeed = 1.0f;
+	this->movementSpeed = 6.0f;
+	this->rotationSpeed = 60.0f;
 
 	this->facingDirection = Camera::calculateFacingDirection(this->yaw, this->pitch);
+	this->previousPosition = this->position;
+	this->previousYaw = this->yaw;
+	this->previousPitch = this->pitch;
 
 	std::cout << "Constructor: ";
 	this->printData();
@@ -182,20 +234,70 @@ Camera::Camera(glm::vec3 position, float yaw, float pitch, float fiedOfView) {
 	this->yaw = yaw;
 	this->pitch = pitch;
 	this->fieldOfView = fieldOfView;
-	this->movementSpeed = 0.1f;
-	this->rotationSpeed = 1.0f;
+	this->movementSpeed = 6.0f;
+	this->rotationSpeed = 60.0f;
 
 	this->facingDirection = Camera::calculateFacingDirection(this->yaw, this->pitch);
+	this->previousPosition = this->position;
+	this->previousYaw = this->yaw;
+	this->previousPitch = this->pitch;
 
 }
 glm::mat4 Camera::getViewMatrix() {
-	return glm::lookAt(
-		this->position,
-		this->position + this->facingDirection,
-		WORLD_UP);
+	if (this->isViewDirty) {
+		// Yaw wraps around, so it blends over the shortest way
+		float yawDifference = this->yaw - this->previousYaw;
+		if (yawDifference > CAMERA_MAX_YAW / 2.0f)
+			yawDifference -= CAMERA_MAX_YAW;
+		else if (yawDifference < -CAMERA_MAX_YAW / 2.0f)
+			yawDifference += CAMERA_MAX_YAW;
+		float yaw = this->previousYaw + yawDifference * this->interpolation;
+		float pitch = this->previousPitch + (this->pitch - this->previousPitch) * this->interpolation;
+		glm::vec3 position = glm::mix(this->previousPosition, this->position, this->interpolation);
+
+		this->viewMatrix = glm::lookAt(
+			position,
+			position + Camera::calculateFacingDirection(yaw, pitch),
+			WORLD_UP);
+		this->isViewDirty = false;
+		this->isViewProjectionDirty = true;
+	}
+	return this->viewMatrix;
 }
 glm::mat4 Camera::getProjectionMatrix(int panelWidth, int panelHeight) {
-	return glm::perspective(glm::radians(this->fieldOfView), (float)panelWidth / (float)panelHeight, 0.02f, 1000.0f);
+	if (this->isProjectionDirty || panelWidth != this->projectionWidth || panelHeight != this->projectionHeight) {
+		this->projectionMatrix = glm::perspective(glm::radians(this->fieldOfView), (float)panelWidth / (float)panelHeight, 0.02f, 1000.0f);
+		this->projectionWidth = panelWidth;
+		this->projectionHeight = panelHeight;
+		this->isProjectionDirty = false;
+		this->isViewProjectionDirty = true;
+	}
+	return this->projectionMatrix;
+}
+glm::mat4 Camera::getViewProjectionMatrix(int panelWidth, int panelHeight) {
+	// Both update first, they mark the product dirty when they change
+	this->getViewMatrix();
+	this->getProjectionMatrix(panelWidth, panelHeight);
+	if (this->isViewProjectionDirty) {
+		this->viewProjectionMatrix = this->projectionMatrix * this->viewMatrix;
+		this->isViewProjectionDirty = false;
+	}
+	return this->viewProjectionMatrix;
+}
+void Camera::step(float deltaTime) {
+	this->previousPosition = this->position;
+	this->previousYaw = this->yaw;
+	this->previousPitch = this->pitch;
+	this->isViewDirty = true;
+
+	this->executeMovement(deltaTime);
+	this->executeRotation(deltaTime);
+}
+void Camera::setInterpolation(float interpolation) {
+	if (interpolation != this->interpolation) {
+		this->interpolation = interpolation;
+		this->isViewDirty = true;
+	}
 }
 void Camera::setMovingInDirection(Camera::MovementDirection direction, bool isMoving) {
 	this->isMovingInDirection[direction] = isMoving;
@@ -215,7 +317,7 @@ glm::vec3 Camera::calculateHorizontalFacingDirection(float yaw) {
 					0,
 					sin(glm::radians(yaw)));
 }
-void Camera::executeMovement() {
+void Camera::executeMovement(float deltaTime) {
 	glm::vec3 horizontalFacingVector = glm::normalize(Camera::calculateHorizontalFacingDirection(this->yaw));
 	glm::vec3 leftVector = glm::vec3(-horizontalFacingVector.z, 0, horizontalFacingVector.x);
 
@@ -235,10 +337,11 @@ void Camera::executeMovement() {
 		movementSum -= WORLD_UP;
 
 	if (glm::length(movementSum) >= 1) {
-		this->position += this->movementSpeed * glm::normalize(movementSum);
+		this->position += this->movementSpeed * deltaTime * glm::normalize(movementSum);
+		this->isViewDirty = true;
 	}
 }
-void Camera::executeRotation() {
+void Camera::executeRotation(float deltaTime) {
 	float yawOffset = 0.0f;
 	float pitchOffset = 0.0f;
 	if (this->isRotatingInDirection[RotationDirection::ROTATE_LEFT])
@@ -251,13 +354,25 @@ void Camera::executeRotation() {
 		pitchOffset += this->rotationSpeed;
 
 	if (yawOffset != 0.0f || pitchOffset != 0.0f) {
-		this->rotate(yawOffset, pitchOffset);
+		this->rotate(yawOffset * deltaTime, pitchOffset * deltaTime);
 	}
 }
+bool Camera::isMoving() {
+	for (int i = 0; i < 6; ++i) {
+		if (this->isMovingInDirection[i])
+			return true;
+	}
+	for (int i = 0; i < 4; ++i) {
+		if (this->isRotatingInDirection[i])
+			return true;
+	}
+	return false;
+}
 void Camera::rotate(float addYaw, float addPitch) { 
 	this->yaw = fmod((this->yaw + addYaw), CAMERA_MAX_YAW);
 	this->pitch = Camera::getValueWithinBounds(this->pitch + addPitch, CAMERA_MIN_PITCH, CAMERA_MAX_PITCH);
 	this->facingDirection = Camera::calculateFacingDirection(this->yaw, this->pitch);
+	this->isViewDirty = true;
 
 	//this->printData();
 }
@@ -267,6 +382,16 @@ void Camera::printData() {
 float Camera::getValueWithinBounds(float x, float min, float max) {
 	return std::min(std::max(x, min), max);
 }
+// Model view state
+bool ModelViewPanel::ViewportState::operator==(const ViewportState& other) const {
+	return this->viewProjectionMatrix == other.viewProjectionMatrix
+		&& this->modelRevision == other.modelRevision
+		&& this->textureRevision == other.textureRevision
+		&& this->shaderFeatures == other.shaderFeatures
+		&& this->isBakedMeshUpToDate == other.isBakedMeshUpToDate
+		&& this->hoveredCube == other.hoveredCube;
+}
+
 // Model view
 ModelViewPanel::ModelViewPanel() {
 	if (!modelViewIsInitialised)
@@ -279,52 +404,103 @@ ModelViewPanel::ModelViewPanel() {
 
 	this->opaque = false;
 	this->backgroundColor = glm::vec4(0.0, 0.0, 0.0, 1.0);
+	this->antiAliasing = AntiAliasing::NONE;
+	this->isFxaaApplied = false;
 
 	this->model = nullptr;
 	this->camera = Camera();
+	this->cameraTimer = gui::TimerWheel::INVALID_TIMER;
+	this->nextCameraStepTime = 0.0;
+	this->faceRenderer = new FaceRenderer(cubeShaders);
+	this->bakedMeshRenderer = new BakedMeshRenderer(cubeShaders);
+	this->lastSeenRevision = 0;
+	this->lastChangeTime = 0.0;
+	this->bakedAlphaModeRevision = 0;
+	this->isFirstBake = true;
+	this->shaderFeatures = 0;
+	this->isViewportDirty = true;
+
+	this->selectionListener = nullptr;
+	this->hoveredCube = -1;
+	this->isMouseOver = false;
+	this->pickedViewProjectionMatrix = glm::mat4(0.0f);
+	this->pickedRevision = 0;
+	this->isSelecting = false;
+	this->selectionStart = glm::vec2(0.0f);
+	this->mousePosition = glm::vec2(0.0f);
 
 	gui::Gui::keyManager->registerKeyListener(this);
+	gui::Gui::mouseManager->registerMouseListener(this);
 }
 
 void ModelViewPanel::setViewedModel(Model* model) {
+	// Throw away any mesh baked from the previous model
+	if (this->pendingBake.valid())
+		this->pendingBake.get();
+	this->bakedMeshRenderer->clear();
+
 	this->model = model;
+	if (model != nullptr)
+		this->lastSeenRevision = model->getRevision();
+	this->lastChangeTime = glfwGetTime();
+	this->isFirstBake = true;
+	this->isViewportDirty = true;
+	// Picked again on the next frame, the new model may have the same revision
+	this->pickedViewProjectionMatrix = glm::mat4(0.0f);
 }
 
 void ModelViewPanel::draw() {
-	//glClear(GL_COLOR_BUFFER_BIT);
-	this->camera.executeMovement();
-	this->camera.executeRotation();
-
-	// Draw background with gui shader if necessary
-	if (this->opaque) {
-		gui::Gui::shader->use();
-		gui::Gui::shader->setMat4("transformation", this->transformationMatrix);
-		gui::Gui::shader->setBool("hasTexture", false);
-		gui::Gui::shader->setBool("isTextureColored", false);
-		gui::Gui::shader->setVec4("color", this->backgroundColor);
-
-		glBindVertexArray(gui::Gui::quadVAO);
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+	if (this->panelWidth <= 0 || this->panelHeight <= 0)
+		return;
+
+	// The camera is drawn between its last two steps, so it moves smoothly at any frame rate
+	if (this->cameraTimer != gui::TimerWheel::INVALID_TIMER) {
+		double interpolation = 1.0 - (this->nextCameraStepTime - glfwGetTime()) / CAMERA_STEP_TIME;
+		this->camera.setInterpolation((float)std::min(std::max(interpolation, 0.0), 1.0));
+		gui::Gui::mainWindow->requestRedraw();
 	}
-	
-	glEnable(GL_DEPTH_TEST);
-	glClear(GL_DEPTH_BUFFER_BIT);
 
-	// Set up viewport
-	GLint originalViewport[4];
-	glGetIntegerv(GL_VIEWPORT, originalViewport);
+	// Edits and bakes are picked up every frame, also when the viewport isn't drawn again
+	this->updateModel();
 
-	//std::cout << "Viewport: " << this->panelX << ", " << this->panelY << ", " << this->panelWidth << ", " << this->panelHeight << std::endl;
-	glViewport(this->panelX, this->panelY, this->panelWidth, this->panelHeight);
+	// The camera or the model can move under a mouse that stands still
+	if (this->model != nullptr) {
+		bool isViewChanged = this->camera.getViewProjectionMatrix(this->panelWidth, this->panelHeight) != this->pickedViewProjectionMatrix;
+		if (isViewChanged || this->model->getRevision() != this->pickedRevision)
+			this->updateHoveredCube();
+	}
 
-	this->drawModel();
-	this->drawGrid();
+	// Frames that only change the gui show the viewport as it was drawn before
+	ViewportState state = this->getViewportState();
+	bool isResized = this->viewportTarget.resize(this->panelWidth, this->panelHeight);
+	// Drawn without smoothing while the FXAA shader compiles, and again once it is ready
+	bool isFxaaReady = this->antiAliasing == AntiAliasing::FXAA && fxaaShader->isReady();
+	if (this->antiAliasing == AntiAliasing::FXAA && !isFxaaReady)
+		gui::Gui::mainWindow->requestRedrawAt(glfwGetTime() + BACKGROUND_POLL_INTERVAL);
+	bool isFxaaMissing = isFxaaReady && !this->isFxaaApplied;
+	if (isResized || isFxaaMissing || this->isViewportDirty || !(state == this->drawnViewportState)) {
+		this->drawViewport();
+		this->drawnViewportState = state;
+		this->isViewportDirty = false;
+	}
 
-	glClear(GL_DEPTH_BUFFER_BIT);
-	glDisable(GL_DEPTH_TEST);
+	// Without a background of its own the viewport is blended over the panels behind it
+	render::GlState* glState = render::GlState::getInstance();
+	Shader* shader = gui::Gui::getShader(true);
+	shader->use();
+	shader->setMat4(TRANSFORMATION_UNIFORM, this->viewportTransformationMatrix);
+	render::RenderTarget* shownTarget = this->isFxaaApplied ? &this->filteredTarget : &this->viewportTarget;
+	glState->bindTexture(0, GL_TEXTURE_2D, shownTarget->getColorTexture());
+	glState->setEnabled(render::Capability::BLEND, !this->opaque);
+	glState->setBlendFunction(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
-	// Restore original viewport
-	glViewport(originalViewport[0], originalViewport[1], originalViewport[2], originalViewport[3]);
+	gui::Gui::quadVAO.bind();
+	glDrawArrays(GL_TRIANGLE_FAN, gui::Gui::getQuadFirstVertex(), 4);
+	glState->setEnabled(render::Capability::BLEND, true);
+	glState->setBlendFunction(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	if (this->isSelecting)
+		this->drawMarquee();
 }
 void ModelViewPanel::updateBoundary(gui::Boundary boundary) {
 	this->boundary = boundary;
@@ -338,28 +514,104 @@ void ModelViewPanel::updateBoundary(gui::Boundary boundary) {
 
 	this->panelWidth = (int) ((screenWidth / 2.0f) * gui::Gui::mainWindow->getWindowWidth());
 	this->panelHeight = (int) ((screenHeight / 2.0f) * gui::Gui::mainWindow->getWindowHeight());
+
+	// Shown on the whole pixels it was drawn for, so every pixel is sampled as is.
+	// Rows of the drawn viewport go from bottom to top, the gui quad expects images from top to bottom
+	float windowWidth = (float)gui::Gui::mainWindow->getWindowWidth();
+	float windowHeight = (float)gui::Gui::mainWindow->getWindowHeight();
+	gui::Boundary viewportBoundary;
+	viewportBoundary.top = this->panelY / windowHeight * 2.0f - 1.0f;
+	viewportBoundary.bottom = (this->panelY + this->panelHeight) / windowHeight * 2.0f - 1.0f;
+	viewportBoundary.left = this->panelX / windowWidth * 2.0f - 1.0f;
+	viewportBoundary.right = (this->panelX + this->panelWidth) / windowWidth * 2.0f - 1.0f;
+	this->viewportTransformationMatrix = gui::Gui::getTransformationMatrix(viewportBoundary);
 }
 void ModelViewPanel::setOpaque(bool isOpaque) {
 	this->opaque = isOpaque;
+	this->isViewportDirty = true;
 }
 void ModelViewPanel::setBackgroundColor(glm::vec4 color) {
 	this->backgroundColor = color;
+	this->isViewportDirty = true;
+}
+void ModelViewPanel::setAntiAliasing(AntiAliasing antiAliasing, int sampleCount) {
+	this->antiAliasing = antiAliasing;
+	if (antiAliasing == AntiAliasing::FXAA && fxaaShader == nullptr)
+		fxaaShader = new Shader("resources/shaders/guiVertex.vs", "resources/shaders/fxaaFragment.fs");
+	this->viewportTarget.setSampleCount(antiAliasing == AntiAliasing::MULTISAMPLE ? sampleCount : 1);
+	this->isViewportDirty = true;
+}
+void ModelViewPanel::setSelectionListener(SelectionListener* listener) {
+	this->selectionListener = listener;
+}
+void ModelViewPanel::setSelectedCubes(std::vector<int> cubes) {
+	this->selectedCubes = cubes;
+	this->isViewportDirty = true;
+	if (this->selectionListener != nullptr)
+		this->selectionListener->onSelectionChange(&this->selectedCubes);
+}
+std::vector<int>* ModelViewPanel::getSelectedCubes() {
+	return &this->selectedCubes;
+}
+int ModelViewPanel::getHoveredCube() {
+	return this->hoveredCube;
 }
 
 void ModelViewPanel::onMouseEnter() {
-
+	this->isMouseOver = true;
 }
 void ModelViewPanel::onMouseLeave() {
-
+	this->isMouseOver = false;
+	this->hoveredCube = -1;
+	this->isSelecting = false;
 }
 void ModelViewPanel::onMousePress(int button, int mods) {
+	if (button != GLFW_MOUSE_BUTTON_LEFT)
+		return;
 
+	this->isSelecting = true;
+	this->selectionStart = this->mousePosition;
 }
 void ModelViewPanel::onMouseRelease(int button, int mods) {
+	if (button != GLFW_MOUSE_BUTTON_LEFT || !this->isSelecting)
+		return;
+	this->isSelecting = false;
 
+	bool addToSelection = (mods & GLFW_MOD_SHIFT) != 0;
+
+	// Compare the distance the mouse moved in pixels
+	glm::vec2 movement = (this->mousePosition - this->selectionStart) * 0.5f;
+	movement.x *= gui::Gui::mainWindow->getWindowWidth();
+	movement.y *= gui::Gui::mainWindow->getWindowHeight();
+
+	if (glm::length(movement) >= CLICK_DISTANCE) {
+		this->selectCubesInMarquee(addToSelection);
+		return;
+	}
+
+	// The view may have changed since the mouse last moved
+	this->updateHoveredCube();
+
+	std::vector<int> cubes;
+	if (addToSelection)
+		cubes = this->selectedCubes;
+
+	if (this->hoveredCube >= 0) {
+		auto position = std::find(cubes.begin(), cubes.end(), this->hoveredCube);
+		if (position == cubes.end())
+			cubes.push_back(this->hoveredCube);
+		else if (addToSelection)
+			cubes.erase(position);
+	}
+	this->setSelectedCubes(cubes);
 }
 void ModelViewPanel::onMouseScroll(double horizontalScroll, double verticalScroll) {
 
+}
+void ModelViewPanel::onMouseMove(float mouseX, float mouseY) {
+	this->mousePosition = glm::vec2(mouseX, mouseY);
+	this->isMouseOver = true;
+	this->updateHoveredCube();
 }
 gui::Boundary ModelViewPanel::getBoundary() {
 	return this->boundary;
@@ -401,6 +653,12 @@ void ModelViewPanel::onKeyPress(int keyCode, int mods, int action) {
 			break;
 
 	}
+
+	// Start stepping the camera when the first movement key goes down
+	if (this->camera.isMoving() && this->cameraTimer == gui::TimerWheel::INVALID_TIMER) {
+		this->nextCameraStepTime = glfwGetTime();
+		this->cameraTimer = gui::Gui::timers->schedule(this->nextCameraStepTime, [this] { this->stepCamera(); });
+	}
 }
 void ModelViewPanel::onFocus() {
 
@@ -409,134 +667,337 @@ void ModelViewPanel::onDefocus() {
 
 }
 
-void ModelViewPanel::drawModel() {
-	if (this->model == nullptr)
-		return;
+void ModelViewPanel::drawViewport() {
+	render::GlState* glState = render::GlState::getInstance();
 
-	cubeShader->use();
-	// Initialise camera position and view into shader
-	glm::mat4 projectionMatrix = this->camera.getProjectionMatrix(this->panelWidth, this->panelHeight);
-	cubeShader->setMat4("projectionMatrix", projectionMatrix);
-	glm::mat4 viewMatrix = this->camera.getViewMatrix();
-	cubeShader->setMat4("viewMatrix", viewMatrix);
+	// The original viewport is known without asking GL
+	int originalViewport[4];
+	glState->getViewport(originalViewport);
 
-	std::vector<Cube>* cubes = this->model->getCubes();
-	for (auto it = cubes->begin(); it != cubes->end(); ++it) {
-		Cube cube = *it;
+	this->viewportTarget.bind();
+	glState->setViewport(0, 0, this->viewportTarget.getWidth(), this->viewportTarget.getHeight());
 
-		this->drawCube(cube);
+	// Cleared to nothing without a background, so the panels behind show through
+	glm::vec4 clearColor = this->opaque ? this->backgroundColor : glm::vec4(0.0f);
+	glClearBufferfv(GL_COLOR, 0, &clearColor[0]);
+	glClear(GL_DEPTH_BUFFER_BIT);
+	glState->setEnabled(render::Capability::DEPTH_TEST, true);
+	glState->setEnabled(render::Capability::MULTISAMPLE, true);
+	// The target holds premultiplied colors, so it can be blended over the gui without applying alpha twice
+	glState->setBlendFunction(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+	// Camera values are shared by all passes below
+	this->frameUniforms.update(
+		this->camera.getViewMatrix(),
+		this->camera.getProjectionMatrix(this->panelWidth, this->panelHeight),
+		this->camera.getViewProjectionMatrix(this->panelWidth, this->panelHeight),
+		glm::vec2((float)this->panelWidth, (float)this->panelHeight),
+		(float)glfwGetTime());
+	this->frameUniforms.bind();
+
+	// The passes only submit their draws, which are sorted to share state
+	this->drawModel();
+	this->drawGrid();
+	this->drawSelection();
+	this->renderQueue.execute();
+	// Translucent draws turn blending off again afterwards, the gui still needs it
+	glState->setEnabled(render::Capability::BLEND, true);
+	glState->setBlendFunction(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glState->setEnabled(render::Capability::DEPTH_TEST, false);
+
+	// Samples are averaged and edges smoothed once here, not every time the viewport is shown
+	this->viewportTarget.resolve();
+	this->isFxaaApplied = this->antiAliasing == AntiAliasing::FXAA && fxaaShader->isReady();
+	if (this->isFxaaApplied)
+		this->applyFxaa();
+	render::RenderTarget::bindWindow();
+	glState->setViewport(originalViewport[0], originalViewport[1], originalViewport[2], originalViewport[3]);
+}
+void ModelViewPanel::applyFxaa() {
+	render::GlState* glState = render::GlState::getInstance();
+	this->filteredTarget.resize(this->viewportTarget.getWidth(), this->viewportTarget.getHeight());
+	this->filteredTarget.bind();
+	glState->setEnabled(render::Capability::BLEND, false);
+
+	// The gui quad reads images from top to bottom, mirrored it keeps the rows of the target where they are
+	fxaaShader->use();
+	fxaaShader->setMat4(TRANSFORMATION_UNIFORM, glm::scale(glm::mat4(1.0f), glm::vec3(1.0f, -1.0f, 1.0f)));
+	fxaaShader->setVec2(TEXEL_SIZE_UNIFORM, glm::vec2(1.0f / this->viewportTarget.getWidth(), 1.0f / this->viewportTarget.getHeight()));
+	glState->bindTexture(0, GL_TEXTURE_2D, this->viewportTarget.getColorTexture());
+
+	gui::Gui::quadVAO.bind();
+	glDrawArrays(GL_TRIANGLE_FAN, gui::Gui::getQuadFirstVertex(), 4);
+	glState->setEnabled(render::Capability::BLEND, true);
+}
+ModelViewPanel::ViewportState ModelViewPanel::getViewportState() {
+	ViewportState state;
+	state.viewProjectionMatrix = this->camera.getViewProjectionMatrix(this->panelWidth, this->panelHeight);
+	if (this->model != nullptr) {
+		state.modelRevision = this->model->getRevision();
+		state.isBakedMeshUpToDate = this->bakedMeshRenderer->isUpToDate(state.modelRevision);
 	}
+	state.textureRevision = TextureRegistry::getInstance()->getRevision();
+	state.shaderFeatures = this->shaderFeatures;
+	state.hoveredCube = this->hoveredCube;
+	return state;
 }
-void ModelViewPanel::drawCube(Cube cube) {
-	// Get matrices
-	glm::mat4 modelMatrix = ModelViewPanel::getModelMatrix(&cube);
+void ModelViewPanel::updateModel() {
+	if (this->model == nullptr)
+		return;
 
-	cubeShader->setMat4("modelMatrix", modelMatrix);
-	glBindVertexArray(cube.getVAO());
+	TextureRegistry* textureRegistry = TextureRegistry::getInstance();
+	this->faceRenderer->update(this->model, textureRegistry->getAlphaModes(), textureRegistry->getAlphaModeRevision());
+	this->bvh.update(this->model);
+	this->updateBakedMesh();
+	this->model->clearChanges();
+
+	// Textures of all faces are layers of one array, sampling is left out until there are any
+	// and until the textured variants finished compiling. Only cutout textures need alpha testing
+	bool isBakedMeshUpToDate = this->bakedMeshRenderer->isUpToDate(this->model->getRevision());
+	unsigned int instancedFeature = isBakedMeshUpToDate ? 0 : SHADER_INSTANCED;
+	unsigned int texturedFeatures = SHADER_TEXTURED | (textureRegistry->hasAlphaMode(AlphaMode::CUTOUT) ? SHADER_ALPHA_TESTED : 0);
+	bool hasTranslucentFaces = this->faceRenderer->getTranslucentInstanceCount() > 0;
+	// The baked mesh draws its opaque part without alpha testing, translucent faces are blended instead
+	bool isTexturedReady = cubeShaders->isReady(texturedFeatures | instancedFeature)
+		&& (!isBakedMeshUpToDate || cubeShaders->isReady(SHADER_TEXTURED))
+		&& (!hasTranslucentFaces || cubeShaders->isReady(SHADER_TEXTURED | SHADER_INSTANCED));
+
+	this->shaderFeatures = 0;
+	if (textureRegistry->getTextureCount() > 0 && isTexturedReady)
+		this->shaderFeatures = texturedFeatures;
+	else if (textureRegistry->getTextureCount() > 0)
+		gui::Gui::mainWindow->requestRedrawAt(glfwGetTime() + BACKGROUND_POLL_INTERVAL);
+}
+void ModelViewPanel::drawModel() {
+	if (this->model == nullptr)
+		return;
+
+	render::Frustum frustum = render::Frustum(this->camera.getViewMatrix(), this->camera.getProjectionMatrix(this->panelWidth, this->panelHeight));
 
-	// North face
-	if (!cube.hasTextureAtFace(CubeFace::Orientation::NORTH)) {
-		cubeShader->setBool("hasTexture", false);
-		cubeShader->setVec4("color", defaultCubeFaceColor[CubeFace::Orientation::NORTH]);
+	// Binding uploads the layers that changed
+	TextureRegistry* textureRegistry = TextureRegistry::getInstance();
+	if (this->shaderFeatures != 0)
+		textureRegistry->bind(0);
+	unsigned int texture = textureRegistry->getTextureID();
+
+	if (this->bakedMeshRenderer->isUpToDate(this->model->getRevision())) {
+		// The baked mesh merges faces across cubes, so it can only be culled as a whole
+		if (frustum.intersects(this->bvh.getBounds()))
+			this->bakedMeshRenderer->submit(&this->renderQueue, this->shaderFeatures, texture);
 	} else {
-		cubeShader->setBool("hasTexture", false);
-		cubeShader->setVec4("color", glm::vec4(0.0, 0.0, 0.0, 1.0));
+		// Model is being edited, draw the faces of visible cubes directly
+		this->visibleCubes.clear();
+		this->bvh.findVisibleCubes(frustum, &this->visibleCubes);
+		this->faceRenderer->submit(&this->renderQueue, &this->visibleCubes, this->shaderFeatures, texture);
 	}
-	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
-	// East face
-	if (!cube.hasTextureAtFace(CubeFace::Orientation::EAST)) {
-		cubeShader->setBool("hasTexture", false);
-		cubeShader->setVec4("color", defaultCubeFaceColor[CubeFace::Orientation::EAST]);
-	} else {
-		cubeShader->setBool("hasTexture", false);
-		cubeShader->setVec4("color", glm::vec4(0.0, 0.0, 0.0, 1.0));
+	// Neither of the above contains translucent faces, those are sorted back to front every time the view changes
+	this->faceRenderer->submitTranslucent(&this->renderQueue, this->camera.getViewMatrix(), this->shaderFeatures, texture);
+}
+void ModelViewPanel::updateBakedMesh() {
+	unsigned int revision = this->model->getRevision();
+	if (revision != this->lastSeenRevision) {
+		this->lastSeenRevision = revision;
+		this->lastChangeTime = glfwGetTime();
 	}
-	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(6 * sizeof(float)));
 
-	// South face
-	if (!cube.hasTextureAtFace(CubeFace::Orientation::SOUTH)) {
-		cubeShader->setBool("hasTexture", false);
-		cubeShader->setVec4("color", defaultCubeFaceColor[CubeFace::Orientation::SOUTH]);
-	} else {
-		cubeShader->setBool("hasTexture", false);
-		cubeShader->setVec4("color", glm::vec4(0.0, 0.0, 0.0, 1.0));
+	// The alpha mode of a texture decides where its faces go in the mesh, so a change has to be baked again
+	TextureRegistry* textureRegistry = TextureRegistry::getInstance();
+	unsigned int alphaModeRevision = textureRegistry->getAlphaModeRevision();
+	bool isAlphaModeChanged = alphaModeRevision != this->bakedAlphaModeRevision;
+	if (isAlphaModeChanged && !this->pendingBake.valid()) {
+		this->bakedMeshRenderer->clear();
+		this->bakedAlphaModeRevision = alphaModeRevision;
 	}
-	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(12 * sizeof(float)));
 
-	// West face
-	if (!cube.hasTextureAtFace(CubeFace::Orientation::WEST)) {
-		cubeShader->setBool("hasTexture", false);
-		cubeShader->setVec4("color", defaultCubeFaceColor[CubeFace::Orientation::WEST]);
-	} else {
-		cubeShader->setBool("hasTexture", false);
-		cubeShader->setVec4("color", glm::vec4(0.0, 0.0, 0.0, 1.0));
+	// Pick up a finished bake, unless the model or the alpha modes changed in the meantime
+	if (this->pendingBake.valid() && this->pendingBake.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+		BakedMesh mesh = this->pendingBake.get();
+		if (mesh.revision == revision && !isAlphaModeChanged)
+			this->bakedMeshRenderer->upload(&mesh);
+		else
+			gui::Gui::mainWindow->requestRedraw();	// To bake again
 	}
-	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(18 * sizeof(float)));
 
-	// Up face
-	if (!cube.hasTextureAtFace(CubeFace::Orientation::UP)) {
-		cubeShader->setBool("hasTexture", false);
-		cubeShader->setVec4("color", defaultCubeFaceColor[CubeFace::Orientation::UP]);
-	} else {
-		cubeShader->setBool("hasTexture", false);
-		cubeShader->setVec4("color", glm::vec4(0.0, 0.0, 0.0, 1.0));
+	// Start baking on a worker once edits have settled
+	bool isSettled = glfwGetTime() - this->lastChangeTime >= BAKE_SETTLE_TIME;
+	bool needsBake = !this->pendingBake.valid() && !this->bakedMeshRenderer->isUpToDate(revision);
+	if (needsBake && isSettled) {
+		this->bakedAlphaModeRevision = alphaModeRevision;
+		this->pendingBake = std::async(std::launch::async, &ModelBaker::bake, *this->model->getCubes(), *textureRegistry->getAlphaModes(), revision, this->isFirstBake);
+		this->isFirstBake = false;
+	} else if (needsBake) {
+		gui::Gui::mainWindow->requestRedrawAt(this->lastChangeTime + BAKE_SETTLE_TIME);
 	}
-	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(24 * sizeof(float)));
+	if (this->pendingBake.valid())
+		gui::Gui::mainWindow->requestRedrawAt(glfwGetTime() + BACKGROUND_POLL_INTERVAL);
+}
+void ModelViewPanel::stepCamera() {
+	this->cameraTimer = gui::TimerWheel::INVALID_TIMER;
 
-	// Down face
-	if (!cube.hasTextureAtFace(CubeFace::Orientation::DOWN)) {
-		cubeShader->setBool("hasTexture", false);
-		cubeShader->setVec4("color", defaultCubeFaceColor[CubeFace::Orientation::DOWN]);
-	} else {
-		cubeShader->setBool("hasTexture", false);
-		cubeShader->setVec4("color", glm::vec4(0.0, 0.0, 0.0, 1.0));
+	// Every step that is due runs now, so late frames don't slow the camera down
+	double time = glfwGetTime();
+	int stepCount = 0;
+	while (this->nextCameraStepTime <= time) {
+		this->camera.step((float)CAMERA_STEP_TIME);
+		this->nextCameraStepTime += CAMERA_STEP_TIME;
+
+		if (++stepCount == MAX_CAMERA_STEPS) {
+			this->nextCameraStepTime = time + CAMERA_STEP_TIME;
+			break;
+		}
 	}
-	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(30 * sizeof(float)));
+	gui::Gui::mainWindow->requestRedraw();
+
+	// A step after the keys are released settles the camera, so it isn't left halfway between two steps
+	if (stepCount > 0 && !this->camera.isMoving())
+		return;
+	this->cameraTimer = gui::Gui::timers->schedule(this->nextCameraStepTime, [this] { this->stepCamera(); });
 }
-void ModelViewPanel::drawGrid() {
-	lineShader->use();
-	
-	glm::mat4 projectionMatrix = this->camera.getProjectionMatrix(this->panelWidth, this->panelHeight);
-	lineShader->setMat4("projectionMatrix", projectionMatrix);
-	glm::mat4 viewMatrix = this->camera.getViewMatrix();
-	lineShader->setMat4("viewMatrix", viewMatrix);
-	glm::mat4 modelMatrix = glm::mat4(1.0f);
-	lineShader->setMat4("modelMatrix", modelMatrix);
+void ModelViewPanel::updateHoveredCube() {
+	this->hoveredCube = -1;
+	if (this->model == nullptr || this->panelWidth <= 0 || this->panelHeight <= 0)
+		return;
 
-	glBindVertexArray(gridVAO);
+	glm::mat4 viewProjectionMatrix = this->camera.getViewProjectionMatrix(this->panelWidth, this->panelHeight);
+	this->pickedViewProjectionMatrix = viewProjectionMatrix;
+	this->pickedRevision = this->model->getRevision();
+	if (!this->isMouseOver)
+		return;
+
+	// Unproject the mouse onto the near and far plane
+	glm::vec2 panelPosition = this->toPanelCoordinates(this->mousePosition);
+	glm::mat4 inverseMatrix = glm::inverse(viewProjectionMatrix);
+
+	glm::vec4 nearPoint = inverseMatrix * glm::vec4(panelPosition, -1.0f, 1.0f);
+	glm::vec4 farPoint = inverseMatrix * glm::vec4(panelPosition, 1.0f, 1.0f);
+	glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+	glm::vec3 direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - origin);
 
-	// Draw x axis
-	lineShader->setVec4("color", glm::vec4(1.0, 0.0, 0.0, 1.0));
-	glDrawArrays(GL_LINES, 0, 2);
+	float distance;
+	this->hoveredCube = this->bvh.pickCube(origin, direction, &distance);
+}
+void ModelViewPanel::selectCubesInMarquee(bool addToSelection) {
+	if (this->model == nullptr || this->panelWidth <= 0 || this->panelHeight <= 0)
+		return;
 
-	// Draw y axis
-	lineShader->setVec4("color", glm::vec4(0.0, 1.0, 0.0, 1.0));
-	glDrawArrays(GL_LINES, 2, 2);
+	glm::vec2 start = this->toPanelCoordinates(this->selectionStart);
+	glm::vec2 end = this->toPanelCoordinates(this->mousePosition);
+	glm::vec2 minimum = glm::min(start, end);
+	glm::vec2 maximum = glm::max(start, end);
+	glm::vec2 center = (minimum + maximum) * 0.5f;
+	glm::vec2 scale = 2.0f / glm::max(maximum - minimum, glm::vec2(MIN_MARQUEE_SIZE));
 
-	// Draw z axis
-	lineShader->setVec4("color", glm::vec4(0.0, 0.0, 1.0, 1.0));
-	glDrawArrays(GL_LINES, 4, 2);
+	// Stretch the rectangle over the whole clip space, so the frustum only contains what is inside of it
+	glm::mat4 pickMatrix = glm::mat4(1.0f);
+	pickMatrix[0][0] = scale.x;
+	pickMatrix[1][1] = scale.y;
+	pickMatrix[3][0] = -center.x * scale.x;
+	pickMatrix[3][1] = -center.y * scale.y;
 
-	// Draw rest of grid
-	lineShader->setVec4("color", glm::vec4(1.0, 1.0, 1.0, 1.0));
-	glDrawArrays(GL_LINES, 6, 70);
+	glm::mat4 projectionMatrix = this->camera.getProjectionMatrix(this->panelWidth, this->panelHeight);
+	render::Frustum frustum = render::Frustum(this->camera.getViewMatrix(), pickMatrix * projectionMatrix);
+
+	std::vector<int> cubes;
+	this->bvh.findCubesInFrustum(frustum, &cubes);
+
+	if (addToSelection) {
+		// Searched in the marquee result only, which is sorted, appending would unsort it
+		std::vector<int> marqueeCubes = cubes;
+		for (int cube : this->selectedCubes) {
+			if (!std::binary_search(marqueeCubes.begin(), marqueeCubes.end(), cube))
+				cubes.push_back(cube);
+		}
+	}
+	this->setSelectedCubes(cubes);
+}
+glm::vec2 ModelViewPanel::toPanelCoordinates(glm::vec2 screenPosition) {
+	return glm::vec2(
+		(screenPosition.x - this->boundary.left) / (this->boundary.right - this->boundary.left) * 2.0f - 1.0f,
+		(screenPosition.y - this->boundary.bottom) / (this->boundary.top - this->boundary.bottom) * 2.0f - 1.0f
+	);
 }
-glm::mat4 ModelViewPanel::getModelMatrix(Cube* cube) {
-	glm::mat4 modelMatrix = glm::mat4(1.0f);
+void ModelViewPanel::drawSelection() {
+	if (this->model == nullptr)
+		return;
 
-	// Move to pivot point
-	modelMatrix = glm::translate(modelMatrix, cube->getRotation().origin);
-	// Rotate around pivot point
-	modelMatrix = glm::rotate(modelMatrix, cube->getRotationAngleInRadians(), cube->getRotation().getAxisVector());
-	// Move back from pivot point
-	modelMatrix = glm::translate(modelMatrix, -cube->getRotation().origin);
+	std::vector<Cube>* cubes = this->model->getCubes();
+	glm::mat4 viewMatrix = this->camera.getViewMatrix();
+	int firstVertex = render::BufferArena::getVertexArena()->getOffset(gridAllocation) / GRID_VERTEX_SIZE + CUBE_OUTLINE_FIRST_VERTEX;
+
+	// Selected cubes first, so a hovered cube that is also selected shows the hover color
+	std::vector<int> outlinedCubes = this->selectedCubes;
+	if (this->hoveredCube >= 0)
+		outlinedCubes.push_back(this->hoveredCube);
+
+	for (int i = 0; i < (int)outlinedCubes.size(); ++i) {
+		int cubeIndex = outlinedCubes[i];
+		if (cubeIndex < 0 || cubeIndex >= (int)cubes->size())
+			continue;
+
+		Cube* cube = &(*cubes)[cubeIndex];
+		glm::mat4 modelMatrix = cube->getModelMatrix();
+		modelMatrix = glm::translate(modelMatrix, glm::vec3(-0.5f - OUTLINE_MARGIN));
+		modelMatrix = glm::scale(modelMatrix, cube->getSize() + glm::vec3(2.0f * OUTLINE_MARGIN));
+
+		bool isHovered = i == (int)outlinedCubes.size() - 1 && cubeIndex == this->hoveredCube;
+		glm::vec4 color = isHovered ? HOVER_COLOR : SELECTION_COLOR;
+
+		render::DrawPayload payload;
+		payload.shader = lineShader;
+		payload.vertexArray = gridVAO.getID();
+		payload.draw = [modelMatrix, color, firstVertex](Shader* shader) {
+			shader->setMat4(MODEL_MATRIX_UNIFORM, modelMatrix);
+			shader->setVec4(COLOR_UNIFORM, color);
+			glDrawArrays(GL_LINES, firstVertex, CUBE_OUTLINE_VERTEX_COUNT);
+		};
+
+		// Nearest outlines first, so farther ones fail the depth test early
+		float depth = -(viewMatrix * modelMatrix * glm::vec4(0.5f, 0.5f, 0.5f, 1.0f)).z;
+		this->renderQueue.submit(render::RenderQueue::makeKey(render::RenderLayer::OPAQUE, lineShader->program.getID(), 0, depth), std::move(payload));
+	}
+}
+void ModelViewPanel::drawMarquee() {
+	gui::Boundary marquee;
+	marquee.top = std::max(this->selectionStart.y, this->mousePosition.y);
+	marquee.bottom = std::min(this->selectionStart.y, this->mousePosition.y);
+	marquee.left = std::min(this->selectionStart.x, this->mousePosition.x);
+	marquee.right = std::max(this->selectionStart.x, this->mousePosition.x);
 
-	// Align cube with grid
-	modelMatrix = glm::translate(modelMatrix, glm::vec3(0.5, 0.5, 0.5));
+	Shader* shader = gui::Gui::getShader(false);
+	shader->use();
+	shader->setMat4(TRANSFORMATION_UNIFORM, gui::Gui::getTransformationMatrix(marquee));
+	shader->setVec4(COLOR_UNIFORM, MARQUEE_COLOR);
 
-	// Move to position
-	modelMatrix = glm::translate(modelMatrix, cube->getPosition());
+	gui::Gui::quadVAO.bind();
+	glDrawArrays(GL_TRIANGLE_FAN, gui::Gui::getQuadFirstVertex(), 4);
+}
+void ModelViewPanel::drawGrid() {
+	int firstVertex = render::BufferArena::getVertexArena()->getOffset(gridAllocation) / GRID_VERTEX_SIZE;
+
+	// The axes in red, green and blue, followed by the rest of the grid
+	const int lineFirstVertices[] = { 0, 2, 4, AXIS_VERTEX_COUNT };
+	const int lineVertexCounts[] = { 2, 2, 2, GRID_LINE_VERTEX_COUNT };
+	const glm::vec4 lineColors[] = {
+		glm::vec4(1.0, 0.0, 0.0, 1.0),
+		glm::vec4(0.0, 1.0, 0.0, 1.0),
+		glm::vec4(0.0, 0.0, 1.0, 1.0),
+		glm::vec4(1.0, 1.0, 1.0, 1.0)
+	};
 
-	return modelMatrix;
+	for (int i = 0; i < 4; ++i) {
+		render::DrawPayload payload;
+		payload.shader = lineShader;
+		payload.vertexArray = gridVAO.getID();
+
+		int first = firstVertex + lineFirstVertices[i];
+		int count = lineVertexCounts[i];
+		glm::vec4 color = lineColors[i];
+		payload.draw = [first, count, color](Shader* shader) {
+			shader->setMat4(MODEL_MATRIX_UNIFORM, glm::mat4(1.0f));
+			shader->setVec4(COLOR_UNIFORM, color);
+			glDrawArrays(GL_LINES, first, count);
+		};
+		this->renderQueue.submit(render::RenderQueue::makeKey(render::RenderLayer::OPAQUE, lineShader->program.getID(), 0, 0.0f), std::move(payload));
+	}
 }
\ No newline at end of file
@@ -1,10 +1,19 @@
 #pragma once
 
+#include <future>
+
 #include "../gui/Gui.h"
+#include "../render/FrameUniforms.h"
+#include "../render/RenderQueue.h"
+#include "../render/RenderTarget.h"
 #include "Model.h"
+#include "ModelRenderer.h"
+#include "ModelBaker.h"
+#include "CubeBVH.h"
+#include "TextureRegistry.h"
 
 void initialiseModelView();
-unsigned int createGridVAO();
+void createGridVAO();
 std::vector<float> getGridVertices();
 
 class Camera {
@@ -27,14 +36,20 @@ class Camera {
 		Camera();
 		Camera(glm::vec3 position, float pitch, float yaw, float fieldOfView);
 
+		// Matrices are cached until the camera moves or the panel is resized
 		glm::mat4 getViewMatrix();
 		glm::mat4 getProjectionMatrix(int panelWidth, int panelHeight);
+		glm::mat4 getViewProjectionMatrix(int panelWidth, int panelHeight);
 
 		void setMovingInDirection(Camera::MovementDirection direction, bool isMoving);
 		void setRotatingInDirection(Camera::RotationDirection direction, bool isRotating);
 
-		void executeMovement();
-		void executeRotation();
+		// Moves and rotates the camera for the held keys over a fixed time step
+		void step(float deltaTime);
+		// Fraction of the way from the previous step to the current one at which the camera is drawn
+		void setInterpolation(float interpolation);
+		// Whether a key is held that moves or rotates the camera
+		bool isMoving();
 
 		void rotate(float addYaw, float addPitch);
 
@@ -46,12 +61,30 @@ class Camera {
 		float pitch;
 		float fieldOfView;
 
-		float movementSpeed;
-		float rotationSpeed;
+		float movementSpeed;		// Units per second
+		float rotationSpeed;		// Degrees per second
+
+		// State before the last step, the view blends from it to the current state
+		glm::vec3 previousPosition;
+		float previousYaw;
+		float previousPitch;
+		float interpolation = 1.0f;
 		
 		bool isMovingInDirection[6] = {false};
 		bool isRotatingInDirection[4] = {false};
 
+		glm::mat4 viewMatrix;
+		glm::mat4 projectionMatrix;
+		glm::mat4 viewProjectionMatrix;
+		int projectionWidth = 0;
+		int projectionHeight = 0;
+		bool isViewDirty = true;
+		bool isProjectionDirty = true;
+		bool isViewProjectionDirty = true;
+
+		void executeMovement(float deltaTime);
+		void executeRotation(float deltaTime);
+
 		static glm::vec3 calculateFacingDirection(float yaw, float pitch);
 		static glm::vec3 calculateHorizontalFacingDirection(float yaw);
 		static float getValueWithinBounds(float x, float min, float max);
@@ -59,6 +92,12 @@ class Camera {
 
 class ModelViewPanel : public gui::Element, public gui::FocusListener, public gui::MouseListener, public gui::KeyListener {
 	public:
+		enum class AntiAliasing : int {
+			NONE = 0,
+			MULTISAMPLE = 1,	// Every pixel is sampled several times, the samples are averaged once per drawn viewport
+			FXAA = 2			// Edges are blurred after drawing, cheaper but softer
+		};
+
 		ModelViewPanel();
 
 		void setViewedModel(Model* model);
@@ -68,6 +107,13 @@ class ModelViewPanel : public gui::Element, public gui::FocusListener, public gu
 
 		void setBackgroundColor(glm::vec4 color);
 		void setOpaque(bool isOpaque);
+		// The sample count is only used for multisampling
+		void setAntiAliasing(AntiAliasing antiAliasing, int sampleCount);
+
+		void setSelectionListener(SelectionListener* listener);
+		void setSelectedCubes(std::vector<int> cubes);
+		std::vector<int>* getSelectedCubes();
+		int getHoveredCube();
 
 		// Mouse listener methods
 		void onMouseEnter() override;
@@ -75,6 +121,7 @@ class ModelViewPanel : public gui::Element, public gui::FocusListener, public gu
 		void onMousePress(int button, int mods) override;
 		void onMouseRelease(int button, int mods) override;
 		void onMouseScroll(double horizontalScroll, double verticalScroll) override;
+		void onMouseMove(float mouseX, float mouseY) override;
 
 		gui::Boundary getBoundary() override;
 
@@ -87,6 +134,17 @@ class ModelViewPanel : public gui::Element, public gui::FocusListener, public gu
 		void onDefocus();
 
 	private:
+		// What the drawn viewport shows that can change without the panel being told
+		struct ViewportState {
+			glm::mat4 viewProjectionMatrix = glm::mat4(0.0f);
+			unsigned int modelRevision = 0;
+			unsigned int textureRevision = 0;
+			unsigned int shaderFeatures = 0;
+			bool isBakedMeshUpToDate = false;
+			int hoveredCube = -1;
+
+			bool operator==(const ViewportState& other) const;
+		};
 		
 		int panelX;
 		int panelY;
@@ -96,11 +154,63 @@ class ModelViewPanel : public gui::Element, public gui::FocusListener, public gu
 		bool opaque;
 		glm::vec4 backgroundColor;
 
+		// The 3D view is drawn into its own target and only drawn again when what it shows changes
+		render::RenderTarget viewportTarget;
+		AntiAliasing antiAliasing;
+		// The viewport with FXAA applied, shown instead of the viewport target when there is one
+		render::RenderTarget filteredTarget;
+		bool isFxaaApplied;
+		ViewportState drawnViewportState;
+		bool isViewportDirty;
+		glm::mat4 viewportTransformationMatrix;
+
 		Model* model;
 		Camera camera;
-
+		// Steps the camera while a movement key is held
+		int cameraTimer;
+		double nextCameraStepTime;
+		render::FrameUniforms frameUniforms;
+		// Draws of all passes, executed together once they are submitted
+		render::RenderQueue renderQueue;
+		FaceRenderer* faceRenderer;
+		unsigned int shaderFeatures;		// Textured once there are textures and their shaders are ready
+
+		// Cubes outside of the view are not drawn
+		CubeBVH bvh;
+		std::vector<int> visibleCubes;
+
+		// Static mesh drawn while the model isn't being edited
+		BakedMeshRenderer* bakedMeshRenderer;
+		std::future<BakedMesh> pendingBake;
+		unsigned int lastSeenRevision;
+		double lastChangeTime;
+		unsigned int bakedAlphaModeRevision;		// Translucent faces are left out of the mesh, cutout faces go last
+		bool isFirstBake;		// The first bake after opening a model is looked up in the asset cache
+
+		// Selection, mouse positions are in screen coordinates
+		SelectionListener* selectionListener;
+		std::vector<int> selectedCubes;
+		int hoveredCube;
+		bool isMouseOver;
+		// What the hovered cube was picked with, it is picked again once either changes
+		glm::mat4 pickedViewProjectionMatrix;
+		unsigned int pickedRevision;
+		bool isSelecting;
+		glm::vec2 selectionStart;
+		glm::vec2 mousePosition;
+
+		void drawViewport();
+		void applyFxaa();
+		ViewportState getViewportState();
+		void updateModel();
 		void drawModel();
-		void drawCube(Cube cube);
+		void updateBakedMesh();
+		void stepCamera();
 		void drawGrid();
-		static glm::mat4 getModelMatrix(Cube* cube);
+		void drawSelection();
+		void drawMarquee();
+
+		void updateHoveredCube();
+		void selectCubesInMarquee(bool addToSelection);
+		glm::vec2 toPanelCoordinates(glm::vec2 screenPosition);
 };
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include <glad/glad.h>
+#include <iostream>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define USE_SSE2
+	#include <emmintrin.h>
+#endif
+
+#include "TextureRegistry.h"
+
+// Size of most resource pack textures, layers grow when a larger texture is loaded
+static const int DEFAULT_LAYER_SIZE = 16;
+
+// Magenta and black checkers, shown while loading and for files that can't be read
+static const unsigned char PLACEHOLDER_PIXELS[] = {
+	255, 0, 255, 255,	0, 0, 0, 255,
+	0, 0, 0, 255,		255, 0, 255, 255
+};
+static const int PLACEHOLDER_SIZE = 2;
+
+// TextureRegistry
+TextureRegistry::TextureRegistry() : textureArray(DEFAULT_LAYER_SIZE) {
+	this->revision = 0;
+	this->alphaModeRevision = 0;
+}
+int TextureRegistry::loadTexture(std::string path) {
+	auto found = this->layersByPath.find(path);
+	if (found != this->layersByPath.end())
+		return found->second;
+
+	std::cout << "Loading: " << path << std::endl;
+
+	Texture texture;
+	texture.path = path;
+	texture.layer = this->textureArray.addLayer(PLACEHOLDER_PIXELS, PLACEHOLDER_SIZE, PLACEHOLDER_SIZE);
+
+	this->textures.push_back(texture);
+	this->layersByPath[path] = texture.layer;
+	this->alphaModes.push_back(AlphaMode::OPAQUE);
+	this->revision++;
+
+	int layer = texture.layer;
+	render::TextureLoader::getInstance()->load(path, [this, layer](render::DecodedImage* image) {
+		this->onTextureDecoded(layer, image);
+	});
+	return layer;
+}
+Texture* TextureRegistry::getTexture(int layer) {
+	if (layer < 0 || layer >= (int)this->textures.size())
+		return nullptr;
+	return &this->textures[layer];
+}
+int TextureRegistry::getTextureCount() {
+	return (int)this->textures.size();
+}
+void TextureRegistry::bind(int textureUnit) {
+	this->textureArray.bind(textureUnit);
+}
+unsigned int TextureRegistry::getTextureID() {
+	return this->textureArray.getTextureID();
+}
+unsigned int TextureRegistry::getRevision() {
+	return this->revision;
+}
+const std::vector<AlphaMode>* TextureRegistry::getAlphaModes() {
+	return &this->alphaModes;
+}
+bool TextureRegistry::hasAlphaMode(AlphaMode alphaMode) {
+	return std::find(this->alphaModes.begin(), this->alphaModes.end(), alphaMode) != this->alphaModes.end();
+}
+unsigned int TextureRegistry::getAlphaModeRevision() {
+	return this->alphaModeRevision;
+}
+void TextureRegistry::onTextureDecoded(int layer, render::DecodedImage* image) {
+	if (!image->succeeded) {
+		std::cout << "Failed to load texture: " << image->path << std::endl;
+		return;
+	}
+
+	// Animated textures are a vertical strip of square frames, only the first frame is used
+	int frameHeight = image->height;
+	if (image->height > image->width && image->height % image->width == 0)
+		frameHeight = image->width;
+
+	Texture* texture = &this->textures[layer];
+	texture->width = image->width;
+	texture->height = frameHeight;
+	texture->isLoaded = true;
+	texture->alphaMode = TextureRegistry::classifyAlpha(image->getPixels(0), image->width * frameHeight);
+
+	if (texture->alphaMode != this->alphaModes[layer]) {
+		this->alphaModes[layer] = texture->alphaMode;
+		this->alphaModeRevision++;
+	}
+
+	this->textureArray.setLayer(layer, image->getPixels(0), image->width, frameHeight);
+	this->revision++;
+}
+AlphaMode TextureRegistry::classifyAlpha(const unsigned char* pixels, int pixelCount) {
+	bool hasTransparentPixels = false;
+	int i = 0;
+
+#ifdef USE_SSE2
+	// Four pixels at a time, alpha is the highest byte of every 32 bit lane
+	const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+	const __m128i zero = _mm_setzero_si128();
+	__m128i transparentLanes = zero;
+	for (; i + 4 <= pixelCount; i += 4) {
+		__m128i alpha = _mm_and_si128(_mm_loadu_si128((const __m128i*)(pixels + i * 4)), alphaMask);
+		__m128i isTransparent = _mm_cmpeq_epi32(alpha, zero);
+		__m128i isOpaque = _mm_cmpeq_epi32(alpha, alphaMask);
+
+		// A single pixel in between is enough, so stop right there
+		if (_mm_movemask_epi8(_mm_or_si128(isTransparent, isOpaque)) != 0xFFFF)
+			return AlphaMode::TRANSLUCENT;
+		transparentLanes = _mm_or_si128(transparentLanes, isTransparent);
+	}
+	hasTransparentPixels = _mm_movemask_epi8(transparentLanes) != 0;
+#endif
+
+	// Pixels left over, or all of them without SSE2
+	for (; i < pixelCount; ++i) {
+		unsigned char alpha = pixels[i * 4 + 3];
+		if (alpha != 0 && alpha != 255)
+			return AlphaMode::TRANSLUCENT;
+		if (alpha == 0)
+			hasTransparentPixels = true;
+	}
+
+	return hasTransparentPixels ? AlphaMode::CUTOUT : AlphaMode::OPAQUE;
+}
+TextureRegistry* TextureRegistry::getInstance() {
+	static TextureRegistry* registry = new TextureRegistry();
+	return registry;
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <map>
+
+#include "../render/TextureArray.h"
+#include "../render/TextureLoader.h"
+#include "Model.h"
+
+class TextureRegistry {
+	/*
+		Loads the textures of models into a single texture array, so a whole model is drawn with one texture binding.
+		Every file is loaded once, faces refer to the layer it was given.
+	*/
+	public:
+		TextureRegistry();
+
+		// Layer of the texture, loaded on first use. The layer shows a placeholder until the file is decoded
+		int loadTexture(std::string path);
+		Texture* getTexture(int layer);
+		int getTextureCount();
+
+		void bind(int textureUnit);
+		unsigned int getTextureID();
+
+		// Changes whenever a texture is added or finishes loading
+		unsigned int getRevision();
+
+		// How faces with the texture of a layer are drawn, by layer
+		const std::vector<AlphaMode>* getAlphaModes();
+		bool hasAlphaMode(AlphaMode alphaMode);
+		// Changes whenever the alpha mode of a layer changes
+		unsigned int getAlphaModeRevision();
+
+		// Shared by all models, created on first use
+		static TextureRegistry* getInstance();
+
+	private:
+		render::TextureArray textureArray;
+		std::vector<Texture> textures;
+		std::map<std::string, int> layersByPath;
+		std::vector<AlphaMode> alphaModes;
+		unsigned int revision;
+		unsigned int alphaModeRevision;
+
+		void onTextureDecoded(int layer, render::DecodedImage* image);
+		static AlphaMode classifyAlpha(const unsigned char* pixels, int pixelCount);
+};
\ No newline at end of file
@@ -0,0 +1,243 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <atomic>
+#include <cstdio>
+#include <cerrno>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+	#include <direct.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+#include "AssetCache.h"
+
+static const std::string CACHE_DIRECTORY = "cache";
+static const unsigned int ENTRY_MAGIC = 0x43414349;	// "ICAC"
+// Increase when the layout of entries changes
+static const unsigned int ENTRY_VERSION = 1;
+
+struct EntryHeader {
+	unsigned int magic;
+	unsigned int version;
+	unsigned long long key;
+	unsigned long long payloadSize;
+};
+
+// Makes temporary file names unique between threads storing the same entry
+static std::atomic<unsigned int> temporaryFileCounter(0);
+
+static bool createDirectory(std::string path) {
+#ifdef _WIN32
+	return _mkdir(path.c_str()) == 0 || errno == EEXIST;
+#else
+	return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+// MappedFile
+MappedFile::MappedFile(std::string path) {
+	this->data = nullptr;
+	this->size = 0;
+	this->fileHandle = nullptr;
+	this->mappingHandle = nullptr;
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		CloseHandle(file);
+		return;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		CloseHandle(file);
+		return;
+	}
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return;
+	}
+
+	this->data = (const unsigned char*)view;
+	this->size = (size_t)fileSize.QuadPart;
+	this->fileHandle = file;
+	this->mappingHandle = mapping;
+#else
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+		return;
+
+	struct stat fileStatus;
+	if (fstat(file, &fileStatus) != 0 || fileStatus.st_size == 0) {
+		close(file);
+		return;
+	}
+
+	void* view = mmap(nullptr, (size_t)fileStatus.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	// The mapping keeps the file alive on its own
+	close(file);
+	if (view == MAP_FAILED)
+		return;
+
+	this->data = (const unsigned char*)view;
+	this->size = (size_t)fileStatus.st_size;
+#endif
+}
+MappedFile::~MappedFile() {
+	if (this->data == nullptr)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(this->data);
+	CloseHandle((HANDLE)this->mappingHandle);
+	CloseHandle((HANDLE)this->fileHandle);
+#else
+	munmap((void*)this->data, this->size);
+#endif
+}
+bool MappedFile::isOpen() const {
+	return this->data != nullptr;
+}
+const unsigned char* MappedFile::getData() const {
+	return this->data;
+}
+size_t MappedFile::getSize() const {
+	return this->size;
+}
+
+// AssetCache::Entry
+AssetCache::Entry::Entry(std::unique_ptr<MappedFile> file) : file(std::move(file)) {}
+const unsigned char* AssetCache::Entry::getPayload() const {
+	return this->file->getData() + sizeof(EntryHeader);
+}
+size_t AssetCache::Entry::getPayloadSize() const {
+	return this->file->getSize() - sizeof(EntryHeader);
+}
+
+// AssetCache
+AssetCache::AssetCache(std::string directory) {
+	this->directory = directory;
+	this->directoryExists = createDirectory(directory);
+	this->hitCount = 0;
+	this->missCount = 0;
+	this->storeCount = 0;
+
+	if (!this->directoryExists)
+		std::cout << "Can't create asset cache directory: " << directory << std::endl;
+}
+std::shared_ptr<AssetCache::Entry> AssetCache::find(std::string kind, unsigned long long key) {
+	std::unique_ptr<MappedFile> file(new MappedFile(this->getEntryPath(kind, key)));
+
+	// Entries written by another version or cut short are ignored, storing again replaces them
+	bool isValid = false;
+	if (file->isOpen() && file->getSize() >= sizeof(EntryHeader)) {
+		const EntryHeader* header = (const EntryHeader*)file->getData();
+		isValid = header->magic == ENTRY_MAGIC
+			&& header->version == ENTRY_VERSION
+			&& header->key == key
+			&& header->payloadSize == file->getSize() - sizeof(EntryHeader);
+	}
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if (!isValid) {
+		this->missCount++;
+		return nullptr;
+	}
+	this->hitCount++;
+	return std::make_shared<Entry>(std::move(file));
+}
+bool AssetCache::store(std::string kind, unsigned long long key, const void* payload, size_t payloadSize) {
+	if (!this->directoryExists)
+		return false;
+
+	EntryHeader header;
+	header.magic = ENTRY_MAGIC;
+	header.version = ENTRY_VERSION;
+	header.key = key;
+	header.payloadSize = payloadSize;
+
+	// Written under another name first, so a half written entry is never found
+	std::string path = this->getEntryPath(kind, key);
+	std::string temporaryPath = path + "." + std::to_string(temporaryFileCounter++) + ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		file.write((const char*)&header, sizeof(header));
+		file.write((const char*)payload, payloadSize);
+		if (!file.good()) {
+			file.close();
+			std::remove(temporaryPath.c_str());
+			return false;
+		}
+	}
+
+	// Renaming fails on Windows when the entry exists, which then already holds the same data
+	std::remove(path.c_str());
+	if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+		std::remove(temporaryPath.c_str());
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->storeCount++;
+	return true;
+}
+int AssetCache::getHitCount() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->hitCount;
+}
+int AssetCache::getMissCount() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->missCount;
+}
+void AssetCache::printStatistics() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	std::cout << "Asset cache: " << this->hitCount << " hits, " << this->missCount << " misses, " << this->storeCount << " stored" << std::endl;
+}
+unsigned long long AssetCache::hash(const void* data, size_t size) {
+	return AssetCache::hash(data, size, FNV_OFFSET_BASIS);
+}
+unsigned long long AssetCache::hash(const void* data, size_t size, unsigned long long seed) {
+	const unsigned char* bytes = (const unsigned char*)data;
+	unsigned long long result = seed;
+	for (size_t i = 0; i < size; ++i) {
+		result ^= bytes[i];
+		result *= FNV_PRIME;
+	}
+	return result;
+}
+bool AssetCache::readFile(std::string path, std::vector<unsigned char>* contents) {
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+		return false;
+
+	std::streamsize size = file.tellg();
+	file.seekg(0, std::ios::beg);
+
+	contents->resize((size_t)size);
+	return size == 0 || (bool)file.read((char*)contents->data(), size);
+}
+AssetCache* AssetCache::getInstance() {
+	static AssetCache* cache = new AssetCache(CACHE_DIRECTORY);
+	return cache;
+}
+std::string AssetCache::getEntryPath(std::string kind, unsigned long long key) {
+	std::stringstream path;
+	path << this->directory << "/" << kind << "-" << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+	return path.str();
+}
\ No newline at end of file
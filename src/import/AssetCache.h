@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+// Constants of the 64 bit FNV-1a hash
+const unsigned long long FNV_OFFSET_BASIS = 14695981039346656037ULL;
+const unsigned long long FNV_PRIME = 1099511628211ULL;
+
+class MappedFile {
+	/*
+		Read only view of a whole file, mapped into memory instead of read
+	*/
+	public:
+		MappedFile(std::string path);
+		~MappedFile();
+		MappedFile(const MappedFile& other) = delete;
+		MappedFile& operator=(const MappedFile& other) = delete;
+
+		bool isOpen() const;
+		const unsigned char* getData() const;
+		size_t getSize() const;
+
+	private:
+		const unsigned char* data;
+		size_t size;
+		void* fileHandle;		// Only used on Windows
+		void* mappingHandle;
+};
+
+class AssetCache {
+	/*
+		Stores data derived from assets, like decoded images and baked meshes, in files named after a hash of their source.
+		A changed source has a different hash, so stale entries are never found and don't need to be removed.
+		Entries are mapped back into memory, so reading one is little more than a copy.
+	*/
+	public:
+		// A cached entry, the payload stays valid as long as the entry is kept
+		class Entry {
+			public:
+				Entry(std::unique_ptr<MappedFile> file);
+
+				const unsigned char* getPayload() const;
+				size_t getPayloadSize() const;
+
+			private:
+				std::unique_ptr<MappedFile> file;
+		};
+
+		AssetCache(std::string directory);
+
+		// Kind separates entries of different formats that could share a key. Empty if there is no valid entry
+		std::shared_ptr<Entry> find(std::string kind, unsigned long long key);
+		bool store(std::string kind, unsigned long long key, const void* payload, size_t payloadSize);
+
+		int getHitCount();
+		int getMissCount();
+		void printStatistics();
+
+		// FNV-1a, chain calls by passing the previous hash as seed
+		static unsigned long long hash(const void* data, size_t size);
+		static unsigned long long hash(const void* data, size_t size, unsigned long long seed);
+		static bool readFile(std::string path, std::vector<unsigned char>* contents);
+
+		// Shared by all assets, created on first use
+		static AssetCache* getInstance();
+
+	private:
+		std::string directory;
+		bool directoryExists;
+
+		std::mutex mutex;
+		int hitCount;
+		int missCount;
+		int storeCount;
+
+		std::string getEntryPath(std::string kind, unsigned long long key);
+};
\ No newline at end of file
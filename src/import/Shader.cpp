@@ -3,78 +3,332 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
+#include <cstring>
+#include <algorithm>
 #include <glm.hpp>
 
 #include "Shader.h"
+#include "../render/GlState.h"
 
-Shader::Shader(std::string vertexPath, std::string fragmentPath) {
-    // 1. retrieve the vertex/fragment source code from filePath
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
-    // ensure ifstream objects can throw exceptions:
-    vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    try
-    {
-        // open files
-        vShaderFile.open(vertexPath);
-        fShaderFile.open(fragmentPath);
-        std::stringstream vShaderStream, fShaderStream;
-        // read file's buffer contents into streams
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
-        // close file handlers
-        vShaderFile.close();
-        fShaderFile.close();
-        // convert stream into string
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
-    } catch (std::ifstream::failure& e)
-    {
-        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+static const std::string PROGRAM_CACHE_KIND = "program";
+
+// GL_KHR_parallel_shader_compile, not part of the 3.3 core headers
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+typedef void (APIENTRY* MaxShaderCompilerThreadsFunction)(GLuint count);
+
+// GL_ARB_get_program_binary, the loader only has the 3.3 core functions so these are loaded when the extension is there
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+typedef void (APIENTRY* GetProgramBinaryFunction)(GLuint program, GLsizei bufferSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRY* ProgramBinaryFunction)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRY* ProgramParameteriFunction)(GLuint program, GLenum name, GLint value);
+static GetProgramBinaryFunction getProgramBinary = nullptr;
+static ProgramBinaryFunction programBinary = nullptr;
+static ProgramParameteriFunction programParameteri = nullptr;
+
+bool Shader::isParallelCompileEnabled = false;
+std::unordered_map<std::string, unsigned int> Shader::uniformBlockBindings;
+
+Shader::Shader(std::string vertexPath, std::string fragmentPath) : Shader(vertexPath, fragmentPath, std::vector<std::string>()) {}
+
+Shader::Shader(std::string vertexPath, std::string fragmentPath, std::vector<std::string> defines) {
+    Shader::enableParallelCompile();
+    // 1. retrieve the vertex/fragment source code from filePath, with includes resolved and defines added
+    vertexCode = Shader::preprocess(vertexPath, defines);
+    fragmentCode = Shader::preprocess(fragmentPath, defines);
+    // 2. reuse the program linked by an earlier run with the same driver
+    binaryKey = Shader::getBinaryKey(vertexCode, fragmentCode);
+    isFromBinary = Shader::isBinaryCacheSupported() && this->loadBinary(binaryKey);
+    // 3. compile shaders, the results are only checked on first use so the driver can work on them meanwhile
+    if (!isFromBinary)
+        this->compile();
+    isLinkPending = true;
+}
+
+std::string Shader::preprocess(std::string path, const std::vector<std::string>& defines) {
+    std::vector<std::string> includeStack;
+    std::string source = Shader::readSource(path, &includeStack);
+
+    // defines have to follow the version directive
+    std::string defineLines;
+    for (const std::string& define : defines)
+        defineLines += "#define " + define + "\n";
+
+    size_t versionStart = source.find("#version");
+    size_t insertPosition = 0;
+    if (versionStart != std::string::npos) {
+        size_t versionEnd = source.find('\n', versionStart);
+        insertPosition = versionEnd == std::string::npos ? source.size() : versionEnd + 1;
+        if (versionEnd == std::string::npos)
+            defineLines = "\n" + defineLines;
+    }
+    source.insert(insertPosition, defineLines);
+    return source;
+}
+
+std::string Shader::readSource(std::string path, std::vector<std::string>* includeStack) {
+    if (std::find(includeStack->begin(), includeStack->end(), path) != includeStack->end()) {
+        std::cout << "ERROR::SHADER::RECURSIVE_INCLUDE " << path << std::endl;
+        return "";
+    }
+
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+        return "";
     }
+
+    // includes are relative to the including file
+    size_t directoryEnd = path.find_last_of("/\\");
+    std::string directory = directoryEnd == std::string::npos ? "" : path.substr(0, directoryEnd + 1);
+
+    includeStack->push_back(path);
+    std::stringstream source;
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t directiveStart = line.find_first_not_of(" \t");
+        if (directiveStart != std::string::npos && line.compare(directiveStart, 8, "#include") == 0) {
+            size_t nameStart = line.find('"', directiveStart);
+            size_t nameEnd = nameStart == std::string::npos ? std::string::npos : line.find('"', nameStart + 1);
+            if (nameEnd != std::string::npos) {
+                source << Shader::readSource(directory + line.substr(nameStart + 1, nameEnd - nameStart - 1), includeStack) << "\n";
+                continue;
+            }
+            std::cout << "ERROR::SHADER::INVALID_INCLUDE " << path << ": " << line << std::endl;
+            continue;
+        }
+        source << line << "\n";
+    }
+    includeStack->pop_back();
+    return source.str();
+}
+
+void Shader::compile() {
     const char* vShaderCode = vertexCode.c_str();
     const char* fShaderCode = fragmentCode.c_str();
-    // 2. compile shaders
-    unsigned int vertex, fragment;
     // vertex shader
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
-    glCompileShader(vertex);
-    checkCompileErrors(vertex, "VERTEX");
+    vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertexShader, 1, &vShaderCode, NULL);
+    glCompileShader(vertexShader);
     // fragment Shader
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
-    checkCompileErrors(fragment, "FRAGMENT");
+    fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragmentShader, 1, &fShaderCode, NULL);
+    glCompileShader(fragmentShader);
     // shader Program
-    ID = glCreateProgram();
-    glAttachShader(ID, vertex);
-    glAttachShader(ID, fragment);
-    glLinkProgram(ID);
-    checkCompileErrors(ID, "PROGRAM");
+    program = render::Program::create();
+    glAttachShader(program.getID(), vertexShader);
+    glAttachShader(program.getID(), fragmentShader);
+    if (Shader::isBinaryCacheSupported())
+        programParameteri(program.getID(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(program.getID());
+}
+
+void Shader::finishLinking() {
+    isLinkPending = false;
+
+    if (isFromBinary) {
+        // Drivers may still reject a binary they produced, for example after an update that kept the version string
+        GLint success;
+        glGetProgramiv(program.getID(), GL_LINK_STATUS, &success);
+        if (success) {
+            this->reflectUniforms();
+            this->bindUniformBlocks();
+            this->releaseSources();
+            return;
+        }
+        isFromBinary = false;
+        program = render::Program();
+        this->compile();
+    }
+
+    checkCompileErrors(vertexShader, "VERTEX");
+    checkCompileErrors(fragmentShader, "FRAGMENT");
+    checkCompileErrors(program.getID(), "PROGRAM");
     // delete the shaders as they're linked into our program now and no longer necessery
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    vertexShader = 0;
+    fragmentShader = 0;
+
+    this->reflectUniforms();
+    this->bindUniformBlocks();
+    if (Shader::isBinaryCacheSupported())
+        this->storeBinary(binaryKey);
+    this->releaseSources();
+}
+
+void Shader::reflectUniforms() {
+    uniformLocations.clear();
+
+    GLint uniformCount = 0;
+    GLint maxNameLength = 0;
+    glGetProgramiv(program.getID(), GL_ACTIVE_UNIFORMS, &uniformCount);
+    glGetProgramiv(program.getID(), GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::vector<GLchar> name(std::max(maxNameLength, 1));
+    for (GLint i = 0; i < uniformCount; ++i) {
+        GLsizei nameLength = 0;
+        GLint size;
+        GLenum type;
+        glGetActiveUniform(program.getID(), (GLuint)i, (GLsizei)name.size(), &nameLength, &size, &type, name.data());
+        // Arrays are reported by their first element
+        std::string uniformName(name.data(), nameLength);
+        if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+            uniformName.erase(uniformName.size() - 3);
+
+        GLint location = glGetUniformLocation(program.getID(), uniformName.c_str());
+        // Uniforms in blocks don't have a location
+        if (location >= 0)
+            uniformLocations[UniformName(uniformName.c_str()).hash] = location;
+    }
+}
+
+void Shader::bindUniformBlocks() {
+    GLint blockCount = 0;
+    GLint maxNameLength = 0;
+    glGetProgramiv(program.getID(), GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+    glGetProgramiv(program.getID(), GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxNameLength);
+
+    std::vector<GLchar> name(std::max(maxNameLength, 1));
+    for (GLint i = 0; i < blockCount; ++i) {
+        GLsizei nameLength = 0;
+        glGetActiveUniformBlockName(program.getID(), (GLuint)i, (GLsizei)name.size(), &nameLength, name.data());
+        auto binding = uniformBlockBindings.find(std::string(name.data(), nameLength));
+        if (binding != uniformBlockBindings.end())
+            glUniformBlockBinding(program.getID(), (GLuint)i, binding->second);
+    }
+}
+
+void Shader::setUniformBlockBinding(std::string blockName, unsigned int bindingPoint) {
+    uniformBlockBindings[blockName] = bindingPoint;
+}
+
+void Shader::releaseSources() {
+    std::string().swap(vertexCode);
+    std::string().swap(fragmentCode);
+}
+
+bool Shader::loadBinary(unsigned long long key) {
+    std::shared_ptr<AssetCache::Entry> entry = AssetCache::getInstance()->find(PROGRAM_CACHE_KIND, key);
+    if (!entry || entry->getPayloadSize() <= sizeof(GLenum))
+        return false;
+
+    GLenum format = *(const GLenum*)entry->getPayload();
+    program = render::Program::create();
+    programBinary(program.getID(), format, entry->getPayload() + sizeof(GLenum), (GLsizei)(entry->getPayloadSize() - sizeof(GLenum)));
+    // Whether the driver accepted it is checked on first use
+    return true;
+}
+
+void Shader::storeBinary(unsigned long long key) {
+    GLint success;
+    GLint length = 0;
+    glGetProgramiv(program.getID(), GL_LINK_STATUS, &success);
+    glGetProgramiv(program.getID(), GL_PROGRAM_BINARY_LENGTH, &length);
+    if (!success || length <= 0)
+        return;
+
+    std::vector<unsigned char> payload(sizeof(GLenum) + length);
+    GLenum format;
+    getProgramBinary(program.getID(), length, nullptr, &format, payload.data() + sizeof(GLenum));
+    *(GLenum*)payload.data() = format;
+
+    AssetCache::getInstance()->store(PROGRAM_CACHE_KIND, key, payload.data(), payload.size());
+}
+
+unsigned long long Shader::getBinaryKey(const std::string& vertexCode, const std::string& fragmentCode) {
+    unsigned long long key = AssetCache::hash(vertexCode.data(), vertexCode.size());
+    key = AssetCache::hash(fragmentCode.data(), fragmentCode.size(), key);
+
+    // Binaries only load into the driver that produced them
+    GLenum driverStrings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+    for (GLenum name : driverStrings) {
+        const char* value = (const char*)glGetString(name);
+        if (value != nullptr)
+            key = AssetCache::hash(value, std::strlen(value) + 1, key);
+    }
+    return key;
+}
+
+bool Shader::isBinaryCacheSupported() {
+    // Core since 4.1, on our 3.3 context it depends on ARB_get_program_binary
+    static bool isSupported = [] {
+        if (!glfwExtensionSupported("GL_ARB_get_program_binary"))
+            return false;
+        getProgramBinary = (GetProgramBinaryFunction)glfwGetProcAddress("glGetProgramBinary");
+        programBinary = (ProgramBinaryFunction)glfwGetProcAddress("glProgramBinary");
+        programParameteri = (ProgramParameteriFunction)glfwGetProcAddress("glProgramParameteri");
+        if (getProgramBinary == nullptr || programBinary == nullptr || programParameteri == nullptr)
+            return false;
+        GLint formatCount = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        return formatCount > 0;
+    }();
+    return isSupported;
+}
+
+void Shader::enableParallelCompile() {
+    static bool isEnabled = [] {
+        if (!glfwExtensionSupported("GL_KHR_parallel_shader_compile"))
+            return false;
+        MaxShaderCompilerThreadsFunction maxShaderCompilerThreads = (MaxShaderCompilerThreadsFunction)glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+        if (maxShaderCompilerThreads == nullptr)
+            return false;
+        // Let the driver pick the number of threads
+        maxShaderCompilerThreads(0xFFFFFFFF);
+        return true;
+    }();
+    isParallelCompileEnabled = isEnabled;
+}
+
+bool Shader::isReady() const {
+    if (!isLinkPending || !isParallelCompileEnabled)
+        return true;
+    GLint isCompleted = GL_FALSE;
+    glGetProgramiv(program.getID(), GL_COMPLETION_STATUS_KHR, &isCompleted);
+    return isCompleted == GL_TRUE;
+}
+
+void Shader::use() {
+    if (isLinkPending)
+        this->finishLinking();
+    render::GlState::getInstance()->useProgram(program.getID());
+}
+
+void Shader::setBool(UniformName name, bool value) const {
+    glUniform1i(getUniformLocation(name), (int)value);
+}
 
+void Shader::setInt(UniformName name, int value) const {
+    glUniform1i(getUniformLocation(name), value);
 }
 
-void Shader::use() const {
-    glUseProgram(ID);
+void Shader::setVec2(UniformName name, const glm::vec2& value) const {
+    glUniform2fv(getUniformLocation(name), 1, &value[0]);
 }
 
-void Shader::setBool(const std::string& name, bool value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+void Shader::setVec4(UniformName name, const glm::vec4& value) const {
+    glUniform4fv(getUniformLocation(name), 1, &value[0]);
 }
 
-void Shader::setVec4(const std::string& name, const glm::vec4& value) const {
-    glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+void Shader::setMat4(UniformName name, const glm::mat4& mat) const {
+    glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
-void Shader::setMat4(const std::string& name, const glm::mat4& mat) const {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+GLint Shader::getUniformLocation(UniformName name) const {
+    // Setting location -1 is ignored by GL, like names that were never in the program
+    auto found = uniformLocations.find(name.hash);
+    return found != uniformLocations.end() ? found->second : -1;
 }
 
 void Shader::checkCompileErrors(GLuint shader, std::string type)
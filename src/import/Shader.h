@@ -1,21 +1,86 @@
 #pragma once
 #include <GLFW/glfw3.h>
 #include <string>
+#include <vector>
+#include <unordered_map>
 #include <glm.hpp>
 
+#include "../render/GpuResource.h"
+#include "AssetCache.h"
+
+// Name of a uniform, hashed at compile time when declared constexpr
+class UniformName
+{
+public:
+    unsigned long long hash;
+
+    constexpr UniformName(const char* name) : hash(UniformName::hashName(name, FNV_OFFSET_BASIS)) {}
+
+private:
+    // FNV-1a, the same hash as AssetCache::hash
+    static constexpr unsigned long long hashName(const char* name, unsigned long long hash) {
+        return *name == '\0' ? hash : UniformName::hashName(name + 1, (hash ^ (unsigned char)*name) * FNV_PRIME);
+    }
+};
+
 class Shader
 {
 public:
-    unsigned int ID;
+    render::Program program;
 
     Shader(std::string vertexPath, std::string fragmentPath);
+    // every define is added as "#define <define>" after the version directive
+    Shader(std::string vertexPath, std::string fragmentPath, std::vector<std::string> defines);
 
-    void use() const;
+    // Finishes linking the first time, which waits for the driver if it's still compiling
+    void use();
+    // False while the driver is still compiling in the background, only known with GL_KHR_parallel_shader_compile
+    bool isReady() const;
 
-    void setBool(const std::string& name, bool value) const;
-    void setVec4(const std::string& name, const glm::vec4& value) const;
-    void setMat4(const std::string& name, const glm::mat4& mat) const;
+    // Uniforms that aren't active in the program are ignored
+    void setBool(UniformName name, bool value) const;
+    void setInt(UniformName name, int value) const;
+    void setVec2(UniformName name, const glm::vec2& value) const;
+    void setVec4(UniformName name, const glm::vec4& value) const;
+    void setMat4(UniformName name, const glm::mat4& mat) const;
+    GLint getUniformLocation(UniformName name) const;
+
+    // Programs declaring a uniform block with this name read it from the binding point, set before they are used
+    static void setUniformBlockBinding(std::string blockName, unsigned int bindingPoint);
 
 private:
+    // resolves #include "file" relative to the including file
+    static std::string preprocess(std::string path, const std::vector<std::string>& defines);
+    static std::string readSource(std::string path, std::vector<std::string>* includeStack);
+
+    // Kept until linking is checked, a rejected binary is compiled from them after all
+    std::string vertexCode;
+    std::string fragmentCode;
+    unsigned long long binaryKey;
+    unsigned int vertexShader = 0;
+    unsigned int fragmentShader = 0;
+    bool isFromBinary;
+    bool isLinkPending;
+
+    // Compiling and linking only start the driver's work, errors are checked when linking finishes
+    void compile();
+    void finishLinking();
+    void releaseSources();
+
+    // Locations of all active uniforms by the hash of their name, read once the program is linked
+    std::unordered_map<unsigned long long, GLint> uniformLocations;
+    void reflectUniforms();
+    void bindUniformBlocks();
+    static std::unordered_map<std::string, unsigned int> uniformBlockBindings;
+    // Linked programs are kept in the asset cache, keyed by their sources and the driver that built them
+    bool loadBinary(unsigned long long key);
+    void storeBinary(unsigned long long key);
+    static unsigned long long getBinaryKey(const std::string& vertexCode, const std::string& fragmentCode);
+    static bool isBinaryCacheSupported();
+
+    // Lets the driver compile on its own threads when it supports GL_KHR_parallel_shader_compile
+    static void enableParallelCompile();
+    static bool isParallelCompileEnabled;
+
     void checkCompileErrors(GLuint shader, std::string type);
 };
\ No newline at end of file
@@ -0,0 +1,41 @@
+#include "ShaderVariants.h"
+
+// Define of every feature, in the order of their bits
+static const std::string featureDefines[SHADER_FEATURE_COUNT] = {
+	"TEXTURED",
+	"ALPHA_TESTED",
+	"INSTANCED",
+	"GLYPH"
+};
+
+// ShaderVariants
+ShaderVariants::ShaderVariants(std::string vertexPath, std::string fragmentPath) {
+	this->vertexPath = vertexPath;
+	this->fragmentPath = fragmentPath;
+}
+Shader* ShaderVariants::get(unsigned int features) {
+	auto found = this->variants.find(features);
+	if (found != this->variants.end())
+		return found->second.get();
+
+	Shader* shader = new Shader(this->vertexPath, this->fragmentPath, ShaderVariants::getDefines(features));
+	this->variants[features] = std::unique_ptr<Shader>(shader);
+	return shader;
+}
+void ShaderVariants::prepare(unsigned int features) {
+	this->get(features);
+}
+bool ShaderVariants::isReady(unsigned int features) {
+	return this->get(features)->isReady();
+}
+int ShaderVariants::getVariantCount() {
+	return (int)this->variants.size();
+}
+std::vector<std::string> ShaderVariants::getDefines(unsigned int features) {
+	std::vector<std::string> defines;
+	for (int i = 0; i < SHADER_FEATURE_COUNT; ++i) {
+		if (features & (1u << i))
+			defines.push_back(featureDefines[i]);
+	}
+	return defines;
+}
\ No newline at end of file
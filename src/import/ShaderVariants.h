@@ -0,0 +1,42 @@
+#pragma once
+
+#include <map>
+#include <memory>
+
+#include "Shader.h"
+
+// Features a shader variant is compiled with, each one is a define in the shader source
+enum ShaderFeature : unsigned int {
+	SHADER_TEXTURED = 1 << 0,		// TEXTURED
+	SHADER_ALPHA_TESTED = 1 << 1,	// ALPHA_TESTED, fragments below half opacity are discarded
+	SHADER_INSTANCED = 1 << 2,		// INSTANCED
+	SHADER_GLYPH = 1 << 3			// GLYPH, a region of a textured glyph atlas covers the color
+};
+const int SHADER_FEATURE_COUNT = 4;
+
+class ShaderVariants {
+	/*
+		One pair of shader files, compiled once for every combination of features that is used.
+		Features are selected with defines instead of uniforms, so variants don't branch per fragment.
+		A variant is compiled the first time it is asked for, unless it was prepared in advance.
+	*/
+	public:
+		ShaderVariants(std::string vertexPath, std::string fragmentPath);
+
+		// Variant with exactly these features
+		Shader* get(unsigned int features);
+		// Compiles a variant now, so the first draw using it doesn't wait for the compiler
+		void prepare(unsigned int features);
+		// Whether using a variant won't wait for the compiler, starts compiling it if it wasn't yet
+		bool isReady(unsigned int features);
+
+		int getVariantCount();
+
+	private:
+		std::string vertexPath;
+		std::string fragmentPath;
+
+		std::map<unsigned int, std::unique_ptr<Shader>> variants;
+
+		static std::vector<std::string> getDefines(unsigned int features);
+};
\ No newline at end of file
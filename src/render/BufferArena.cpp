@@ -0,0 +1,238 @@
+#include <glad/glad.h>
+#include <iostream>
+#include <algorithm>
+#include <iterator>
+
+#include "BufferArena.h"
+
+static const int INITIAL_VERTEX_ARENA_CAPACITY = 1 << 20;
+static const int INITIAL_INDEX_ARENA_CAPACITY = 1 << 18;
+
+static int roundUp(int value, int alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+// BufferArena
+render::BufferArena::BufferArena(std::string name, int capacity) {
+	this->name = name;
+	this->capacity = capacity;
+	this->usedSize = 0;
+	this->defragmentationCount = 0;
+	this->growCount = 0;
+
+	// Uploads go through the copy targets, so the element buffer of a bound vertex array is never replaced
+	this->buffer = Buffer::create();
+	glBindBuffer(GL_COPY_WRITE_BUFFER, this->buffer.getID());
+	glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, GL_STATIC_DRAW);
+
+	this->freeRanges[0] = capacity;
+}
+int render::BufferArena::allocate(int size, int alignment) {
+	if (size <= 0 || alignment <= 0)
+		throw InvalidAllocationException();
+
+	int offset = this->findFreeRange(size, alignment);
+	if (offset < 0) {
+		// Compact first, and only grow when the allocation still doesn't fit
+		int requiredCapacity = roundUp(this->getCompactedSize(), alignment) + size;
+		int newCapacity = this->capacity;
+		while (newCapacity < requiredCapacity)
+			newCapacity *= 2;
+
+		if (newCapacity != this->capacity)
+			++this->growCount;
+		this->relocate(newCapacity);
+		offset = this->findFreeRange(size, alignment);
+	}
+	this->takeRange(offset, size);
+
+	int allocation;
+	if (this->unusedBlocks.empty()) {
+		allocation = (int)this->blocks.size();
+		this->blocks.push_back(Block());
+	} else {
+		allocation = this->unusedBlocks.back();
+		this->unusedBlocks.pop_back();
+	}
+
+	Block* block = &this->blocks[allocation];
+	block->offset = offset;
+	block->size = size;
+	block->alignment = alignment;
+	block->inUse = true;
+
+	this->usedSize += size;
+	return allocation;
+}
+void render::BufferArena::release(int allocation) {
+	if (allocation == INVALID_ALLOCATION)
+		return;
+
+	const Block* block = this->getBlock(allocation);
+	this->releaseRange(block->offset, block->size);
+	this->usedSize -= block->size;
+
+	this->blocks[allocation].inUse = false;
+	this->unusedBlocks.push_back(allocation);
+}
+void render::BufferArena::upload(int allocation, const void* data, int size) {
+	const Block* block = this->getBlock(allocation);
+	if (size > block->size)
+		throw InvalidAllocationException();
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, this->buffer.getID());
+	glBufferSubData(GL_COPY_WRITE_BUFFER, block->offset, size, data);
+}
+int render::BufferArena::getOffset(int allocation) const {
+	return this->getBlock(allocation)->offset;
+}
+int render::BufferArena::getSize(int allocation) const {
+	return this->getBlock(allocation)->size;
+}
+unsigned int render::BufferArena::getBufferID() const {
+	return this->buffer.getID();
+}
+void render::BufferArena::defragment() {
+	if (this->freeRanges.size() > 1)
+		this->relocate(this->capacity);
+}
+render::BufferArenaStatistics render::BufferArena::getStatistics() const {
+	BufferArenaStatistics statistics;
+	statistics.capacity = this->capacity;
+	statistics.usedSize = this->usedSize;
+	statistics.allocationCount = (int)(this->blocks.size() - this->unusedBlocks.size());
+	statistics.freeRangeCount = (int)this->freeRanges.size();
+	statistics.defragmentationCount = this->defragmentationCount;
+	statistics.growCount = this->growCount;
+
+	for (auto it = this->freeRanges.begin(); it != this->freeRanges.end(); ++it) {
+		statistics.largestFreeRange = std::max(statistics.largestFreeRange, it->second);
+	}
+	return statistics;
+}
+void render::BufferArena::printStatistics() const {
+	BufferArenaStatistics statistics = this->getStatistics();
+
+	std::cout << "Buffer arena '" << this->name << "':" << std::endl;
+	std::cout << "\tUsed: " << statistics.usedSize << " / " << statistics.capacity << " bytes in " << statistics.allocationCount << " allocations" << std::endl;
+	std::cout << "\tFree ranges: " << statistics.freeRangeCount << ", largest " << statistics.largestFreeRange << " bytes" << std::endl;
+	std::cout << "\tDefragmented " << statistics.defragmentationCount << " times, grown " << statistics.growCount << " times" << std::endl;
+}
+render::BufferArena* render::BufferArena::getVertexArena() {
+	static BufferArena* vertexArena = new BufferArena("Vertices", INITIAL_VERTEX_ARENA_CAPACITY);
+	return vertexArena;
+}
+render::BufferArena* render::BufferArena::getIndexArena() {
+	static BufferArena* indexArena = new BufferArena("Indices", INITIAL_INDEX_ARENA_CAPACITY);
+	return indexArena;
+}
+const render::BufferArena::Block* render::BufferArena::getBlock(int allocation) const {
+	if (allocation < 0 || allocation >= (int)this->blocks.size() || !this->blocks[allocation].inUse)
+		throw InvalidAllocationException();
+	return &this->blocks[allocation];
+}
+int render::BufferArena::findFreeRange(int size, int alignment) const {
+	// First fit, the part skipped for alignment stays free
+	for (auto it = this->freeRanges.begin(); it != this->freeRanges.end(); ++it) {
+		int offset = roundUp(it->first, alignment);
+		if (offset + size <= it->first + it->second)
+			return offset;
+	}
+	return -1;
+}
+void render::BufferArena::takeRange(int offset, int size) {
+	// The free range that contains the offset
+	auto it = --this->freeRanges.upper_bound(offset);
+	int rangeBegin = it->first;
+	int rangeEnd = it->first + it->second;
+	this->freeRanges.erase(it);
+
+	if (rangeBegin < offset)
+		this->freeRanges[rangeBegin] = offset - rangeBegin;
+	if (offset + size < rangeEnd)
+		this->freeRanges[offset + size] = rangeEnd - (offset + size);
+}
+void render::BufferArena::releaseRange(int offset, int size) {
+	auto it = this->freeRanges.insert(std::make_pair(offset, size)).first;
+
+	// Merge with the following range
+	auto next = std::next(it);
+	if (next != this->freeRanges.end() && it->first + it->second == next->first) {
+		it->second += next->second;
+		this->freeRanges.erase(next);
+	}
+
+	// Merge with the preceding range
+	if (it != this->freeRanges.begin()) {
+		auto previous = std::prev(it);
+		if (previous->first + previous->second == it->first) {
+			previous->second += it->second;
+			this->freeRanges.erase(it);
+		}
+	}
+}
+int render::BufferArena::getCompactedSize() const {
+	std::vector<const Block*> liveBlocks;
+	for (auto it = this->blocks.begin(); it != this->blocks.end(); ++it) {
+		if ((*it).inUse)
+			liveBlocks.push_back(&(*it));
+	}
+	std::sort(liveBlocks.begin(), liveBlocks.end(), [](const Block* a, const Block* b) {
+		return a->offset < b->offset;
+	});
+
+	int end = 0;
+	for (auto it = liveBlocks.begin(); it != liveBlocks.end(); ++it) {
+		end = roundUp(end, (*it)->alignment) + (*it)->size;
+	}
+	return end;
+}
+void render::BufferArena::relocate(int newCapacity) {
+	// Keep the order of allocations, so each one only moves towards the start
+	std::vector<Block*> liveBlocks;
+	for (auto it = this->blocks.begin(); it != this->blocks.end(); ++it) {
+		if ((*it).inUse)
+			liveBlocks.push_back(&(*it));
+	}
+	std::sort(liveBlocks.begin(), liveBlocks.end(), [](const Block* a, const Block* b) {
+		return a->offset < b->offset;
+	});
+
+	int compactedSize = this->getCompactedSize();
+	Buffer staging;
+
+	if (compactedSize > 0) {
+		// Ranges of one buffer can't overlap in a copy, so compact into a staging buffer first
+		staging = Buffer::create();
+		glBindBuffer(GL_COPY_WRITE_BUFFER, staging.getID());
+		glBufferData(GL_COPY_WRITE_BUFFER, compactedSize, nullptr, GL_STREAM_COPY);
+		glBindBuffer(GL_COPY_READ_BUFFER, this->buffer.getID());
+
+		int end = 0;
+		for (auto it = liveBlocks.begin(); it != liveBlocks.end(); ++it) {
+			int newOffset = roundUp(end, (*it)->alignment);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (*it)->offset, newOffset, (*it)->size);
+			(*it)->offset = newOffset;
+			end = newOffset + (*it)->size;
+		}
+	}
+
+	// Reallocating the storage keeps the buffer name, and with it every vertex array that uses it
+	glBindBuffer(GL_COPY_WRITE_BUFFER, this->buffer.getID());
+	glBufferData(GL_COPY_WRITE_BUFFER, newCapacity, nullptr, GL_STATIC_DRAW);
+
+	if (compactedSize > 0) {
+		glBindBuffer(GL_COPY_READ_BUFFER, staging.getID());
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, compactedSize);
+	}
+
+	if (newCapacity == this->capacity)
+		++this->defragmentationCount;
+
+	this->capacity = newCapacity;
+	this->freeRanges.clear();
+	if (compactedSize < newCapacity)
+		this->freeRanges[compactedSize] = newCapacity - compactedSize;
+}
+
+InvalidAllocationException::InvalidAllocationException() : std::runtime_error("Invalid buffer arena allocation") {};
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include <string>
+#include <stdexcept>
+
+#include "GpuResource.h"
+
+namespace render {
+
+	struct BufferArenaStatistics {
+		int capacity = 0;
+		int usedSize = 0;
+		int allocationCount = 0;
+		int freeRangeCount = 0;
+		int largestFreeRange = 0;
+		int defragmentationCount = 0;
+		int growCount = 0;
+	};
+
+	class BufferArena {
+		/*
+			Hands out ranges of one large buffer object, so many small meshes share a single buffer.
+			Free ranges are kept sorted by offset and merged with their neighbours when released.
+			Allocations are referred to by handle, because defragmenting moves them to other offsets.
+			The buffer object itself never changes, so vertex arrays that reference it stay valid.
+		*/
+		public:
+			static const int INVALID_ALLOCATION = -1;
+
+			BufferArena(std::string name, int capacity);
+
+			// Alignment also makes offsets usable as first vertex, when it is the vertex size
+			int allocate(int size, int alignment);
+			void release(int allocation);
+			void upload(int allocation, const void* data, int size);
+
+			int getOffset(int allocation) const;
+			int getSize(int allocation) const;
+			unsigned int getBufferID() const;
+
+			// Moves all allocations to the start of the buffer, leaving a single free range
+			void defragment();
+
+			BufferArenaStatistics getStatistics() const;
+			void printStatistics() const;
+
+			// Shared by all static geometry, created on first use
+			static BufferArena* getVertexArena();
+			static BufferArena* getIndexArena();
+
+		private:
+			struct Block {
+				int offset = 0;
+				int size = 0;
+				int alignment = 1;
+				bool inUse = false;
+			};
+
+			std::string name;
+			Buffer buffer;
+			int capacity;
+
+			std::map<int, int> freeRanges;	// Offset to size
+			std::vector<Block> blocks;
+			std::vector<int> unusedBlocks;
+
+			int usedSize;
+			int defragmentationCount;
+			int growCount;
+
+			const Block* getBlock(int allocation) const;
+			int findFreeRange(int size, int alignment) const;
+			void takeRange(int offset, int size);
+			void releaseRange(int offset, int size);
+			int getCompactedSize() const;
+			void relocate(int newCapacity);
+	};
+}
+
+struct InvalidAllocationException : public std::runtime_error {
+	InvalidAllocationException();
+};
\ No newline at end of file
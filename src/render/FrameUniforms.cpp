@@ -0,0 +1,31 @@
+#include <glad/glad.h>
+
+#include "FrameUniforms.h"
+
+// FrameUniforms
+const char* const render::FrameUniforms::BLOCK_NAME = "FrameUniforms";
+
+render::FrameUniforms::FrameUniforms() {
+	this->buffer = Buffer::create();
+	glBindBuffer(GL_UNIFORM_BUFFER, this->buffer.getID());
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(Data), nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+void render::FrameUniforms::update(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, const glm::mat4& viewProjectionMatrix, glm::vec2 viewportSize, float time) {
+	Data data;
+	data.viewMatrix = viewMatrix;
+	data.projectionMatrix = projectionMatrix;
+	data.viewProjectionMatrix = viewProjectionMatrix;
+	data.viewportSize = viewportSize;
+	data.time = time;
+	data.padding = 0.0f;
+
+	// Orphaned first, so writing doesn't wait for draws of the previous frame still reading it
+	glBindBuffer(GL_UNIFORM_BUFFER, this->buffer.getID());
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(Data), nullptr, GL_DYNAMIC_DRAW);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Data), &data);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+void render::FrameUniforms::bind() const {
+	glBindBufferBase(GL_UNIFORM_BUFFER, BINDING_POINT, this->buffer.getID());
+}
\ No newline at end of file
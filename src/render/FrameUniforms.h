@@ -0,0 +1,38 @@
+#pragma once
+
+#include <glm.hpp>
+
+#include "GpuResource.h"
+
+namespace render {
+
+	class FrameUniforms {
+		/*
+			Per frame camera values in a std140 uniform buffer, shared by every 3D program through one binding point.
+			Programs declare the FrameUniforms block from frameUniforms.glsl, Shader binds it when they are linked.
+			The buffer is written once per frame, so more passes don't add matrix math or uploads.
+		*/
+		public:
+			static const unsigned int BINDING_POINT = 0;
+			static const char* const BLOCK_NAME;
+
+			FrameUniforms();
+
+			void update(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, const glm::mat4& viewProjectionMatrix, glm::vec2 viewportSize, float time);
+			// Makes this buffer the one programs read from
+			void bind() const;
+
+		private:
+			// Same layout as the block in frameUniforms.glsl
+			struct Data {
+				glm::mat4 viewMatrix;
+				glm::mat4 projectionMatrix;
+				glm::mat4 viewProjectionMatrix;
+				glm::vec2 viewportSize;
+				float time;
+				float padding;
+			};
+
+			Buffer buffer;
+	};
+}
\ No newline at end of file
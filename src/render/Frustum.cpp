@@ -0,0 +1,102 @@
+#include <cmath>
+#include <algorithm>
+
+#include "Frustum.h"
+
+// BoundingBox
+void render::BoundingBox::expand(glm::vec3 point) {
+	for (int axis = 0; axis < 3; ++axis) {
+		this->minimum[axis] = std::min(this->minimum[axis], point[axis]);
+		this->maximum[axis] = std::max(this->maximum[axis], point[axis]);
+	}
+}
+void render::BoundingBox::expand(BoundingBox other) {
+	this->expand(other.minimum);
+	this->expand(other.maximum);
+}
+glm::vec3 render::BoundingBox::getCenter() const {
+	return (this->minimum + this->maximum) * 0.5f;
+}
+render::BoundingBox render::BoundingBox::transform(BoundingBox box, glm::mat4 matrix) {
+	BoundingBox result;
+	for (int corner = 0; corner < 8; ++corner) {
+		glm::vec3 point = glm::vec3(
+			(corner & 1) ? box.maximum.x : box.minimum.x,
+			(corner & 2) ? box.maximum.y : box.minimum.y,
+			(corner & 4) ? box.maximum.z : box.minimum.z
+		);
+		glm::vec3 transformed = glm::vec3(matrix * glm::vec4(point, 1.0f));
+
+		if (corner == 0) {
+			result.minimum = transformed;
+			result.maximum = transformed;
+		} else {
+			result.expand(transformed);
+		}
+	}
+	return result;
+}
+
+// Frustum
+render::Frustum::Frustum(glm::mat4 viewMatrix, glm::mat4 projectionMatrix) {
+	glm::mat4 matrix = projectionMatrix * viewMatrix;
+
+	// Planes are sums and differences of the rows of the view projection matrix
+	glm::vec4 rows[4];
+	for (int row = 0; row < 4; ++row) {
+		rows[row] = glm::vec4(matrix[0][row], matrix[1][row], matrix[2][row], matrix[3][row]);
+	}
+
+	this->planes[0] = rows[3] + rows[0];	// Left
+	this->planes[1] = rows[3] - rows[0];	// Right
+	this->planes[2] = rows[3] + rows[1];	// Bottom
+	this->planes[3] = rows[3] - rows[1];	// Top
+	this->planes[4] = rows[3] + rows[2];	// Near
+	this->planes[5] = rows[3] - rows[2];	// Far
+
+	for (int i = 0; i < 6; ++i) {
+		this->planes[i] /= glm::length(glm::vec3(this->planes[i]));
+	}
+}
+render::Frustum::Containment render::Frustum::test(const BoundingBox& box) const {
+	Containment containment = Containment::INSIDE;
+
+	for (int i = 0; i < 6; ++i) {
+		glm::vec3 normal = glm::vec3(this->planes[i]);
+
+		// Corners furthest along and against the plane normal
+		glm::vec3 positive = box.minimum;
+		glm::vec3 negative = box.maximum;
+		for (int axis = 0; axis < 3; ++axis) {
+			if (normal[axis] >= 0.0f) {
+				positive[axis] = box.maximum[axis];
+				negative[axis] = box.minimum[axis];
+			}
+		}
+
+		if (glm::dot(normal, positive) + this->planes[i].w < 0.0f)
+			return Containment::OUTSIDE;
+		if (glm::dot(normal, negative) + this->planes[i].w < 0.0f)
+			containment = Containment::INTERSECTING;
+	}
+
+	return containment;
+}
+bool render::Frustum::intersects(const BoundingBox& box) const {
+	return this->test(box) != Containment::OUTSIDE;
+}
+bool render::Frustum::intersects(const glm::vec3* points, int pointCount) const {
+	for (int i = 0; i < 6; ++i) {
+		glm::vec3 normal = glm::vec3(this->planes[i]);
+
+		bool allOutside = true;
+		for (int point = 0; point < pointCount && allOutside; ++point) {
+			if (glm::dot(normal, points[point]) + this->planes[i].w >= 0.0f)
+				allOutside = false;
+		}
+
+		if (allOutside)
+			return false;
+	}
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <glm.hpp>
+
+namespace render {
+
+	struct BoundingBox {
+		glm::vec3 minimum = glm::vec3(0.0f);
+		glm::vec3 maximum = glm::vec3(0.0f);
+
+		void expand(glm::vec3 point);
+		void expand(BoundingBox other);
+		glm::vec3 getCenter() const;
+
+		// Box around all corners of another box after transforming it
+		static BoundingBox transform(BoundingBox box, glm::mat4 matrix);
+	};
+
+	class Frustum {
+		/*
+			The six clipping planes of a camera, in world space
+		*/
+		public:
+			enum class Containment {
+				OUTSIDE,
+				INTERSECTING,
+				INSIDE
+			};
+
+			Frustum(glm::mat4 viewMatrix, glm::mat4 projectionMatrix);
+
+			Containment test(const BoundingBox& box) const;
+			bool intersects(const BoundingBox& box) const;
+			// False only if all points lie outside of the same plane
+			bool intersects(const glm::vec3* points, int pointCount) const;
+
+		private:
+			// Normal in xyz and distance in w, normals point inwards
+			glm::vec4 planes[6];
+	};
+}
\ No newline at end of file
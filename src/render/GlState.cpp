@@ -0,0 +1,209 @@
+#include <glad/glad.h>
+#include <iostream>
+
+#include "GlState.h"
+
+static const GLenum capabilityNames[render::CAPABILITY_COUNT] = {
+	GL_BLEND,
+	GL_DEPTH_TEST,
+	GL_MULTISAMPLE
+};
+
+// GlState
+render::GlState::GlState() {
+	this->issuedCount = 0;
+	this->skippedCount = 0;
+	this->invalidate();
+}
+void render::GlState::useProgram(unsigned int program) {
+	if (!this->count(program != this->program))
+		return;
+	glUseProgram(program);
+	this->program = program;
+}
+void render::GlState::bindVertexArray(unsigned int vertexArray) {
+	if (!this->count(vertexArray != this->vertexArray))
+		return;
+	glBindVertexArray(vertexArray);
+	this->vertexArray = vertexArray;
+}
+void render::GlState::bindFramebuffer(unsigned int framebuffer) {
+	if (!this->count(framebuffer != this->readFramebuffer || framebuffer != this->drawFramebuffer))
+		return;
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	this->readFramebuffer = framebuffer;
+	this->drawFramebuffer = framebuffer;
+}
+void render::GlState::bindFramebuffers(unsigned int readFramebuffer, unsigned int drawFramebuffer) {
+	if (this->count(readFramebuffer != this->readFramebuffer)) {
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer);
+		this->readFramebuffer = readFramebuffer;
+	}
+	if (this->count(drawFramebuffer != this->drawFramebuffer)) {
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFramebuffer);
+		this->drawFramebuffer = drawFramebuffer;
+	}
+}
+void render::GlState::bindTexture(unsigned int target, unsigned int texture) {
+	// GL starts with the first unit active
+	this->bindTexture(this->activeTextureUnit == UNKNOWN ? 0 : (int)this->activeTextureUnit, target, texture);
+}
+void render::GlState::bindTexture(int unit, unsigned int target, unsigned int texture) {
+	this->setActiveTextureUnit(unit);
+
+	int targetIndex = GlState::getTextureTargetIndex(target);
+	if (targetIndex < 0 || unit >= TEXTURE_UNIT_COUNT) {
+		this->count(true);
+		glBindTexture(target, texture);
+		return;
+	}
+
+	if (!this->count(texture != this->textures[unit][targetIndex]))
+		return;
+	glBindTexture(target, texture);
+	this->textures[unit][targetIndex] = texture;
+}
+void render::GlState::setEnabled(Capability capability, bool isEnabled) {
+	int index = (int)capability;
+	if (!this->count(this->capabilities[index] != (int)isEnabled))
+		return;
+	if (isEnabled)
+		glEnable(capabilityNames[index]);
+	else
+		glDisable(capabilityNames[index]);
+	this->capabilities[index] = (int)isEnabled;
+}
+void render::GlState::setBlendFunction(unsigned int sourceFactor, unsigned int destinationFactor) {
+	this->setBlendFunction(sourceFactor, destinationFactor, sourceFactor, destinationFactor);
+}
+void render::GlState::setBlendFunction(unsigned int sourceFactor, unsigned int destinationFactor, unsigned int sourceAlphaFactor, unsigned int destinationAlphaFactor) {
+	bool isChanged = sourceFactor != this->blendSourceFactor || destinationFactor != this->blendDestinationFactor
+		|| sourceAlphaFactor != this->blendSourceAlphaFactor || destinationAlphaFactor != this->blendDestinationAlphaFactor;
+	if (!this->count(isChanged))
+		return;
+	glBlendFuncSeparate(sourceFactor, destinationFactor, sourceAlphaFactor, destinationAlphaFactor);
+	this->blendSourceFactor = sourceFactor;
+	this->blendDestinationFactor = destinationFactor;
+	this->blendSourceAlphaFactor = sourceAlphaFactor;
+	this->blendDestinationAlphaFactor = destinationAlphaFactor;
+}
+void render::GlState::setDepthMask(bool isWritten) {
+	if (!this->count(this->depthMask != (int)isWritten))
+		return;
+	glDepthMask(isWritten ? GL_TRUE : GL_FALSE);
+	this->depthMask = (int)isWritten;
+}
+void render::GlState::setViewport(int x, int y, int width, int height) {
+	bool isChanged = !this->isViewportKnown
+		|| x != this->viewport[0] || y != this->viewport[1]
+		|| width != this->viewport[2] || height != this->viewport[3];
+	if (!this->count(isChanged))
+		return;
+	glViewport(x, y, width, height);
+	this->viewport[0] = x;
+	this->viewport[1] = y;
+	this->viewport[2] = width;
+	this->viewport[3] = height;
+	this->isViewportKnown = true;
+}
+void render::GlState::getViewport(int* viewport) {
+	if (!this->isViewportKnown) {
+		this->count(true);
+		glGetIntegerv(GL_VIEWPORT, this->viewport);
+		this->isViewportKnown = true;
+	}
+	for (int i = 0; i < 4; ++i) {
+		viewport[i] = this->viewport[i];
+	}
+}
+void render::GlState::onDeleted(ResourceType type, unsigned int id) {
+	switch (type) {
+		case ResourceType::VERTEX_ARRAY:
+			if (this->vertexArray == id)
+				this->vertexArray = 0;
+			break;
+		case ResourceType::TEXTURE:
+			for (int unit = 0; unit < TEXTURE_UNIT_COUNT; ++unit) {
+				for (int target = 0; target < TEXTURE_TARGET_COUNT; ++target) {
+					if (this->textures[unit][target] == id)
+						this->textures[unit][target] = 0;
+				}
+			}
+			break;
+		case ResourceType::FRAMEBUFFER:
+			// Drawing falls back to the window
+			if (this->readFramebuffer == id)
+				this->readFramebuffer = 0;
+			if (this->drawFramebuffer == id)
+				this->drawFramebuffer = 0;
+			break;
+		case ResourceType::PROGRAM:
+			// A program in use is only deleted once it's no longer used, so it can't be trusted to stay bound
+			if (this->program == id)
+				this->program = UNKNOWN;
+			break;
+		default:
+			break;
+	}
+}
+void render::GlState::invalidate() {
+	this->program = UNKNOWN;
+	this->vertexArray = UNKNOWN;
+	this->readFramebuffer = UNKNOWN;
+	this->drawFramebuffer = UNKNOWN;
+	this->activeTextureUnit = UNKNOWN;
+	for (int unit = 0; unit < TEXTURE_UNIT_COUNT; ++unit) {
+		for (int target = 0; target < TEXTURE_TARGET_COUNT; ++target) {
+			this->textures[unit][target] = UNKNOWN;
+		}
+	}
+	for (int i = 0; i < CAPABILITY_COUNT; ++i) {
+		this->capabilities[i] = -1;
+	}
+	this->depthMask = -1;
+	this->blendSourceFactor = UNKNOWN;
+	this->blendDestinationFactor = UNKNOWN;
+	this->blendSourceAlphaFactor = UNKNOWN;
+	this->blendDestinationAlphaFactor = UNKNOWN;
+	this->isViewportKnown = false;
+}
+int render::GlState::getIssuedCount() const {
+	return this->issuedCount;
+}
+int render::GlState::getSkippedCount() const {
+	return this->skippedCount;
+}
+void render::GlState::resetCounters() {
+	this->issuedCount = 0;
+	this->skippedCount = 0;
+}
+void render::GlState::printStatistics() const {
+	std::cout << "GL state changes: " << this->issuedCount << " issued, " << this->skippedCount << " skipped" << std::endl;
+}
+render::GlState* render::GlState::getInstance() {
+	static GlState* state = new GlState();
+	return state;
+}
+void render::GlState::setActiveTextureUnit(int unit) {
+	if (!this->count((unsigned int)unit != this->activeTextureUnit))
+		return;
+	glActiveTexture(GL_TEXTURE0 + unit);
+	this->activeTextureUnit = (unsigned int)unit;
+}
+bool render::GlState::count(bool isChanged) {
+	if (isChanged)
+		this->issuedCount++;
+	else
+		this->skippedCount++;
+	return isChanged;
+}
+int render::GlState::getTextureTargetIndex(unsigned int target) {
+	switch (target) {
+		case GL_TEXTURE_2D:
+			return 0;
+		case GL_TEXTURE_2D_ARRAY:
+			return 1;
+		default:
+			return -1;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "GpuResource.h"
+
+namespace render {
+
+	enum class Capability : int {
+		BLEND = 0,
+		DEPTH_TEST = 1,
+		MULTISAMPLE = 2
+	};
+	const int CAPABILITY_COUNT = 3;
+
+	class GlState {
+		/*
+			Shadows the GL state that changes between draws and skips calls that wouldn't change it.
+			All changes to the tracked state have to go through here, otherwise the shadow no longer matches.
+			State is unknown until it is set for the first time, so the first call is never skipped.
+			Only used on the GL thread.
+		*/
+		public:
+			static const int TEXTURE_UNIT_COUNT = 16;
+
+			GlState();
+
+			void useProgram(unsigned int program);
+			void bindVertexArray(unsigned int vertexArray);
+			// Binds for both drawing and reading, 0 is the window
+			void bindFramebuffer(unsigned int framebuffer);
+			// Separately, for copying from one framebuffer into another
+			void bindFramebuffers(unsigned int readFramebuffer, unsigned int drawFramebuffer);
+			// Binds to the active unit, for changing a texture instead of drawing with it
+			void bindTexture(unsigned int target, unsigned int texture);
+			// Leaves the unit active
+			void bindTexture(int unit, unsigned int target, unsigned int texture);
+
+			void setEnabled(Capability capability, bool isEnabled);
+			void setBlendFunction(unsigned int sourceFactor, unsigned int destinationFactor);
+			// Alpha is blended with its own factors
+			void setBlendFunction(unsigned int sourceFactor, unsigned int destinationFactor, unsigned int sourceAlphaFactor, unsigned int destinationAlphaFactor);
+			void setDepthMask(bool isWritten);
+			void setViewport(int x, int y, int width, int height);
+			// Only asks GL the first time, before any viewport was set
+			void getViewport(int* viewport);
+
+			// Deleting an object unbinds it, and a new object may get its name
+			void onDeleted(ResourceType type, unsigned int id);
+			// Call after changing tracked state directly, every next call is issued again
+			void invalidate();
+
+			int getIssuedCount() const;
+			int getSkippedCount() const;
+			void resetCounters();
+			void printStatistics() const;
+
+			// Shared by everything that draws, created on first use
+			static GlState* getInstance();
+
+		private:
+			static const unsigned int UNKNOWN = 0xFFFFFFFF;
+			// Textures are tracked for these targets, others are always bound
+			static const int TEXTURE_TARGET_COUNT = 2;
+
+			unsigned int program;
+			unsigned int vertexArray;
+			unsigned int readFramebuffer;
+			unsigned int drawFramebuffer;
+			unsigned int activeTextureUnit;
+			unsigned int textures[TEXTURE_UNIT_COUNT][TEXTURE_TARGET_COUNT];
+			int capabilities[CAPABILITY_COUNT];		// 1 enabled, 0 disabled, -1 unknown
+			int depthMask;
+			unsigned int blendSourceFactor;
+			unsigned int blendDestinationFactor;
+			unsigned int blendSourceAlphaFactor;
+			unsigned int blendDestinationAlphaFactor;
+			int viewport[4];
+			bool isViewportKnown;
+
+			int issuedCount;
+			int skippedCount;
+
+			void setActiveTextureUnit(int unit);
+			bool count(bool isChanged);
+
+			static int getTextureTargetIndex(unsigned int target);
+	};
+}
\ No newline at end of file
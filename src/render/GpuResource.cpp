@@ -0,0 +1,195 @@
+#include <glad/glad.h>
+#include <iostream>
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+#include "GpuResource.h"
+#include "GlState.h"
+
+static const char* resourceTypeNames[render::RESOURCE_TYPE_COUNT] = {
+	"Vertex arrays",
+	"Buffers",
+	"Textures",
+	"Programs",
+	"Framebuffers",
+	"Renderbuffers"
+};
+
+struct PendingDeletion {
+	render::ResourceType type;
+	unsigned int id;
+};
+
+// Handles may be released on any thread, the queue is only drained on the GL thread
+struct DeletionQueue {
+	std::mutex mutex;
+	std::vector<PendingDeletion> deletions;
+};
+
+// Never destroyed, handles with static storage in other files still release into it when the program exits
+static DeletionQueue* getDeletionQueue() {
+	static DeletionQueue* queue = new DeletionQueue();
+	return queue;
+}
+
+// Objects that are created and not yet deleted, including the ones waiting in the queue
+static std::atomic<int> liveCounts[render::RESOURCE_TYPE_COUNT];
+
+// GpuResource
+render::GpuResource::GpuResource(ResourceType type) {
+	this->type = type;
+	this->id = 0;
+}
+render::GpuResource::GpuResource(ResourceType type, unsigned int id) {
+	this->type = type;
+	this->id = id;
+
+	if (id != 0)
+		++liveCounts[(int)type];
+}
+render::GpuResource::GpuResource(GpuResource&& other) {
+	this->type = other.type;
+	this->id = other.id;
+	other.id = 0;
+}
+render::GpuResource& render::GpuResource::operator=(GpuResource&& other) {
+	if (this != &other) {
+		this->release();
+		this->type = other.type;
+		this->id = other.id;
+		other.id = 0;
+	}
+	return *this;
+}
+render::GpuResource::~GpuResource() {
+	this->release();
+}
+unsigned int render::GpuResource::getID() const {
+	return this->id;
+}
+render::ResourceType render::GpuResource::getType() const {
+	return this->type;
+}
+bool render::GpuResource::isValid() const {
+	return this->id != 0;
+}
+void render::GpuResource::release() {
+	if (this->id == 0)
+		return;
+
+	DeletionQueue* queue = getDeletionQueue();
+	std::lock_guard<std::mutex> lock(queue->mutex);
+	queue->deletions.push_back({ this->type, this->id });
+	this->id = 0;
+}
+void render::GpuResource::collectGarbage() {
+	std::vector<PendingDeletion> pending;
+	{
+		DeletionQueue* queue = getDeletionQueue();
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		pending.swap(queue->deletions);
+	}
+
+	for (auto it = pending.begin(); it != pending.end(); ++it) {
+		switch ((*it).type) {
+			case ResourceType::VERTEX_ARRAY:
+				glDeleteVertexArrays(1, &(*it).id);
+				break;
+			case ResourceType::BUFFER:
+				glDeleteBuffers(1, &(*it).id);
+				break;
+			case ResourceType::TEXTURE:
+				glDeleteTextures(1, &(*it).id);
+				break;
+			case ResourceType::PROGRAM:
+				glDeleteProgram((*it).id);
+				break;
+			case ResourceType::FRAMEBUFFER:
+				glDeleteFramebuffers(1, &(*it).id);
+				break;
+			case ResourceType::RENDERBUFFER:
+				glDeleteRenderbuffers(1, &(*it).id);
+				break;
+		}
+		GlState::getInstance()->onDeleted((*it).type, (*it).id);
+		--liveCounts[(int)(*it).type];
+	}
+}
+int render::GpuResource::getLiveCount(ResourceType type) {
+	return liveCounts[(int)type];
+}
+int render::GpuResource::getTotalLiveCount() {
+	int total = 0;
+	for (int i = 0; i < RESOURCE_TYPE_COUNT; ++i) {
+		total += liveCounts[i];
+	}
+	return total;
+}
+int render::GpuResource::getPendingDeletionCount() {
+	DeletionQueue* queue = getDeletionQueue();
+	std::lock_guard<std::mutex> lock(queue->mutex);
+	return (int)queue->deletions.size();
+}
+void render::GpuResource::printStatistics() {
+	std::cout << "GPU resources:" << std::endl;
+	for (int i = 0; i < RESOURCE_TYPE_COUNT; ++i) {
+		std::cout << "\t" << resourceTypeNames[i] << ": " << liveCounts[i] << std::endl;
+	}
+	std::cout << "\tWaiting for deletion: " << GpuResource::getPendingDeletionCount() << std::endl;
+}
+
+// VertexArray
+render::VertexArray::VertexArray() : GpuResource(ResourceType::VERTEX_ARRAY) {}
+render::VertexArray::VertexArray(unsigned int id) : GpuResource(ResourceType::VERTEX_ARRAY, id) {}
+render::VertexArray render::VertexArray::create() {
+	unsigned int id;
+	glGenVertexArrays(1, &id);
+	return VertexArray(id);
+}
+void render::VertexArray::bind() const {
+	GlState::getInstance()->bindVertexArray(this->getID());
+}
+
+// Buffer
+render::Buffer::Buffer() : GpuResource(ResourceType::BUFFER) {}
+render::Buffer::Buffer(unsigned int id) : GpuResource(ResourceType::BUFFER, id) {}
+render::Buffer render::Buffer::create() {
+	unsigned int id;
+	glGenBuffers(1, &id);
+	return Buffer(id);
+}
+
+// Texture
+render::Texture::Texture() : GpuResource(ResourceType::TEXTURE) {}
+render::Texture::Texture(unsigned int id) : GpuResource(ResourceType::TEXTURE, id) {}
+render::Texture render::Texture::create() {
+	unsigned int id;
+	glGenTextures(1, &id);
+	return Texture(id);
+}
+
+// Program
+render::Program::Program() : GpuResource(ResourceType::PROGRAM) {}
+render::Program::Program(unsigned int id) : GpuResource(ResourceType::PROGRAM, id) {}
+render::Program render::Program::create() {
+	return Program(glCreateProgram());
+}
+
+// Framebuffer
+render::Framebuffer::Framebuffer() : GpuResource(ResourceType::FRAMEBUFFER) {}
+render::Framebuffer::Framebuffer(unsigned int id) : GpuResource(ResourceType::FRAMEBUFFER, id) {}
+render::Framebuffer render::Framebuffer::create() {
+	unsigned int id;
+	glGenFramebuffers(1, &id);
+	return Framebuffer(id);
+}
+
+// Renderbuffer
+render::Renderbuffer::Renderbuffer() : GpuResource(ResourceType::RENDERBUFFER) {}
+render::Renderbuffer::Renderbuffer(unsigned int id) : GpuResource(ResourceType::RENDERBUFFER, id) {}
+render::Renderbuffer render::Renderbuffer::create() {
+	unsigned int id;
+	glGenRenderbuffers(1, &id);
+	return Renderbuffer(id);
+}
\ No newline at end of file
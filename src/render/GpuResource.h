@@ -0,0 +1,99 @@
+#pragma once
+
+namespace render {
+
+	enum class ResourceType : int {
+		VERTEX_ARRAY = 0,
+		BUFFER = 1,
+		TEXTURE = 2,
+		PROGRAM = 3,
+		FRAMEBUFFER = 4,
+		RENDERBUFFER = 5
+	};
+	const int RESOURCE_TYPE_COUNT = 6;
+
+	class GpuResource {
+		/*
+			Owns a single OpenGL object. Handles can be moved but not copied, so every object has exactly one owner.
+			Releasing a handle only queues its object, the object is deleted by collectGarbage() on the GL thread.
+		*/
+		public:
+			GpuResource(const GpuResource& other) = delete;
+			GpuResource& operator=(const GpuResource& other) = delete;
+			GpuResource(GpuResource&& other);
+			GpuResource& operator=(GpuResource&& other);
+			~GpuResource();
+
+			unsigned int getID() const;
+			ResourceType getType() const;
+			bool isValid() const;
+			void release();
+
+			// Deletes every queued object, has to be called with the GL context current
+			static void collectGarbage();
+			static int getLiveCount(ResourceType type);
+			static int getTotalLiveCount();
+			static int getPendingDeletionCount();
+			static void printStatistics();
+
+		protected:
+			GpuResource(ResourceType type);
+			GpuResource(ResourceType type, unsigned int id);
+
+		private:
+			ResourceType type;
+			unsigned int id;
+	};
+
+	// Empty handles own nothing, create() makes the actual object
+	class VertexArray : public GpuResource {
+		public:
+			VertexArray();
+			static VertexArray create();
+
+			void bind() const;
+
+		private:
+			VertexArray(unsigned int id);
+	};
+	class Buffer : public GpuResource {
+		public:
+			Buffer();
+			static Buffer create();
+
+		private:
+			Buffer(unsigned int id);
+	};
+	class Texture : public GpuResource {
+		public:
+			Texture();
+			static Texture create();
+
+		private:
+			Texture(unsigned int id);
+	};
+	class Program : public GpuResource {
+		public:
+			Program();
+			static Program create();
+
+		private:
+			Program(unsigned int id);
+	};
+	class Framebuffer : public GpuResource {
+		public:
+			Framebuffer();
+			static Framebuffer create();
+
+		private:
+			Framebuffer(unsigned int id);
+	};
+	class Renderbuffer : public GpuResource {
+		public:
+			Renderbuffer();
+			static Renderbuffer create();
+
+		private:
+			Renderbuffer(unsigned int id);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+
+namespace render {
+
+	static const int RADIX_BITS = 8;
+	static const int RADIX_SIZE = 1 << RADIX_BITS;
+
+	// Stable sort on the lowest keyBits bits of the keys, least significant digit first.
+	// Passes where all items share their digit are skipped. Buffer is scratch space, kept by callers between sorts
+	template<typename Item, typename GetKey>
+	void radixSort(std::vector<Item>* items, std::vector<Item>* buffer, int keyBits, GetKey getKey) {
+		int itemCount = (int)items->size();
+		if (itemCount < 2)
+			return;
+		buffer->resize(itemCount);
+
+		for (int shift = 0; shift < keyBits; shift += RADIX_BITS) {
+			int counts[RADIX_SIZE] = { 0 };
+			for (const Item& item : *items) {
+				counts[((unsigned long long)getKey(item) >> shift) & (RADIX_SIZE - 1)]++;
+			}
+
+			if (counts[((unsigned long long)getKey((*items)[0]) >> shift) & (RADIX_SIZE - 1)] == itemCount)
+				continue;
+
+			int offset = 0;
+			for (int digit = 0; digit < RADIX_SIZE; ++digit) {
+				int count = counts[digit];
+				counts[digit] = offset;
+				offset += count;
+			}
+			for (const Item& item : *items) {
+				(*buffer)[counts[((unsigned long long)getKey(item) >> shift) & (RADIX_SIZE - 1)]++] = item;
+			}
+			items->swap(*buffer);
+		}
+	}
+}
\ No newline at end of file
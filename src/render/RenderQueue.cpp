@@ -0,0 +1,80 @@
+#include <cstring>
+
+#include "RenderQueue.h"
+#include "GlState.h"
+#include "RadixSort.h"
+
+static const int LAYER_SHIFT = 60;
+static const unsigned long long PROGRAM_MASK = 0xFFF;
+static const unsigned long long TEXTURE_MASK = 0xFFFF;
+
+// Non negative floats keep their order when their bits are compared as integers
+static unsigned int getDepthBits(float depth) {
+	if (!(depth > 0.0f))
+		return 0;
+	unsigned int bits;
+	std::memcpy(&bits, &depth, sizeof(bits));
+	return bits;
+}
+
+// RenderQueue
+unsigned long long render::RenderQueue::makeKey(RenderLayer layer, unsigned int program, unsigned int texture, float depth) {
+	unsigned long long key = (unsigned long long)layer << LAYER_SHIFT;
+	unsigned long long depthBits = getDepthBits(depth);
+
+	if (layer == RenderLayer::TRANSLUCENT) {
+		// layer 4 | inverted depth 32 | program 12 | texture 16
+		key |= (0xFFFFFFFFull - depthBits) << 28;
+		key |= (program & PROGRAM_MASK) << 16;
+		key |= texture & TEXTURE_MASK;
+	} else {
+		// layer 4 | program 12 | texture 16 | depth 32
+		key |= (program & PROGRAM_MASK) << 48;
+		key |= (texture & TEXTURE_MASK) << 32;
+		key |= depthBits;
+	}
+	return key;
+}
+void render::RenderQueue::submit(unsigned long long key, DrawPayload payload) {
+	this->items.push_back({ key, (int)this->payloads.size() });
+	this->payloads.push_back(std::move(payload));
+}
+void render::RenderQueue::execute() {
+	this->sort();
+
+	GlState* glState = GlState::getInstance();
+	for (const Item& item : this->items) {
+		DrawPayload* payload = &this->payloads[item.payload];
+
+		// Blended layers don't write depth, so they don't hide what is drawn behind them later
+		RenderLayer layer = (RenderLayer)(item.key >> LAYER_SHIFT);
+		bool isBlended = layer == RenderLayer::TRANSLUCENT || layer == RenderLayer::OVERLAY;
+		glState->setEnabled(Capability::BLEND, isBlended);
+		glState->setDepthMask(!isBlended);
+
+		// Redundant changes between draws sharing state are skipped by the state cache
+		payload->shader->use();
+		if (payload->vertexArray != 0)
+			glState->bindVertexArray(payload->vertexArray);
+		if (payload->texture != 0)
+			glState->bindTexture(0, payload->textureTarget, payload->texture);
+
+		payload->draw(payload->shader);
+	}
+
+	// Depth is only cleared while writing to it is enabled
+	glState->setDepthMask(true);
+	this->clear();
+}
+void render::RenderQueue::clear() {
+	this->items.clear();
+	this->payloads.clear();
+}
+int render::RenderQueue::getSubmittedCount() const {
+	return (int)this->items.size();
+}
+void render::RenderQueue::sort() {
+	radixSort(&this->items, &this->sortBuffer, 64, [](const Item& item) {
+		return item.key;
+	});
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+
+#include "../import/Shader.h"
+
+namespace render {
+
+	// Layers are drawn one after another, in this order
+	enum class RenderLayer : int {
+		OPAQUE = 0,
+		CUTOUT = 1,			// Alpha tested
+		TRANSLUCENT = 2,	// Blended, drawn back to front
+		OVERLAY = 3
+	};
+
+	struct DrawPayload {
+		Shader* shader = nullptr;
+		unsigned int vertexArray = 0;
+		unsigned int textureTarget = 0;
+		unsigned int texture = 0;		// Bound to unit 0, unless it is 0
+		// Sets the remaining uniforms and issues the draw call, once the state above is set
+		std::function<void(Shader* shader)> draw;
+	};
+
+	class RenderQueue {
+		/*
+			Collects the draws of a frame under 64 bit sort keys and executes them in the order of their keys.
+			Keys group draws by layer, then by program and texture, so following draws share as much state as possible.
+			Translucent draws are ordered by depth before state instead, because blending depends on their order.
+			Keys are radix sorted, which is stable, so draws with equal keys keep the order they were submitted in.
+		*/
+		public:
+			// Depth along the view direction, nearer draws come first except in the translucent layer
+			static unsigned long long makeKey(RenderLayer layer, unsigned int program, unsigned int texture, float depth);
+
+			void submit(unsigned long long key, DrawPayload payload);
+			// Sorts and draws everything submitted since the previous call, then empties the queue.
+			// Blending is enabled for the translucent and overlay layers only, and left as the last layer set it
+			void execute();
+			void clear();
+
+			int getSubmittedCount() const;
+
+		private:
+			struct Item {
+				unsigned long long key;
+				int payload;
+			};
+
+			std::vector<Item> items;
+			std::vector<Item> sortBuffer;
+			std::vector<DrawPayload> payloads;
+
+			void sort();
+	};
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include <glad/glad.h>
+#include <algorithm>
+
+#include "RenderTarget.h"
+#include "GlState.h"
+
+// RenderTarget
+render::RenderTarget::RenderTarget() {
+	this->width = 0;
+	this->height = 0;
+	this->sampleCount = 1;
+	this->requestedSampleCount = 1;
+}
+void render::RenderTarget::setSampleCount(int sampleCount) {
+	// The limit doesn't change while the context lives, so it is only asked for once
+	static int maxSampleCount = []() {
+		int count = 1;
+		glGetIntegerv(GL_MAX_SAMPLES, &count);
+		return std::max(count, 1);
+	}();
+	this->requestedSampleCount = std::min(std::max(sampleCount, 1), maxSampleCount);
+}
+bool render::RenderTarget::resize(int width, int height) {
+	// GL doesn't accept empty storage
+	width = std::max(width, 1);
+	height = std::max(height, 1);
+
+	int sampleCount = this->requestedSampleCount;
+
+	bool isUnchanged = width == this->width && height == this->height && sampleCount == this->sampleCount;
+	if (this->framebuffer.isValid() && isUnchanged)
+		return false;
+
+	this->width = width;
+	this->height = height;
+	this->sampleCount = sampleCount;
+	bool isMultisampled = sampleCount > 1;
+
+	GlState* glState = GlState::getInstance();
+
+	// New objects instead of changing the storage of the old ones, which may still be sampled by queued draws
+	this->colorTexture = Texture::create();
+	glState->bindTexture(GL_TEXTURE_2D, this->colorTexture.getID());
+	// Linear, so shaders can sample between pixels, shown at its own size it still gives every pixel as is
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+	this->depthBuffer = Renderbuffer::create();
+	glBindRenderbuffer(GL_RENDERBUFFER, this->depthBuffer.getID());
+	glRenderbufferStorageMultisample(GL_RENDERBUFFER, isMultisampled ? sampleCount : 0, GL_DEPTH_COMPONENT24, width, height);
+
+	this->framebuffer = Framebuffer::create();
+	glState->bindFramebuffer(this->framebuffer.getID());
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->colorTexture.getID(), 0);
+
+	if (isMultisampled) {
+		// Only resolved into, so it needs no depth
+		this->checkComplete();
+
+		this->multisampleColorBuffer = Renderbuffer::create();
+		glBindRenderbuffer(GL_RENDERBUFFER, this->multisampleColorBuffer.getID());
+		glRenderbufferStorageMultisample(GL_RENDERBUFFER, sampleCount, GL_RGBA8, width, height);
+
+		this->multisampleFramebuffer = Framebuffer::create();
+		glState->bindFramebuffer(this->multisampleFramebuffer.getID());
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->multisampleColorBuffer.getID());
+	} else {
+		this->multisampleColorBuffer.release();
+		this->multisampleFramebuffer.release();
+	}
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, this->depthBuffer.getID());
+	this->checkComplete();
+
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	glState->bindFramebuffer(0);
+	return true;
+}
+void render::RenderTarget::bind() {
+	bool isMultisampled = this->multisampleFramebuffer.isValid();
+	GlState::getInstance()->bindFramebuffer(isMultisampled ? this->multisampleFramebuffer.getID() : this->framebuffer.getID());
+}
+void render::RenderTarget::resolve() {
+	if (!this->multisampleFramebuffer.isValid())
+		return;
+
+	GlState::getInstance()->bindFramebuffers(this->multisampleFramebuffer.getID(), this->framebuffer.getID());
+	glBlitFramebuffer(0, 0, this->width, this->height, 0, 0, this->width, this->height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+}
+void render::RenderTarget::bindWindow() {
+	GlState::getInstance()->bindFramebuffer(0);
+}
+int render::RenderTarget::getWidth() const {
+	return this->width;
+}
+int render::RenderTarget::getHeight() const {
+	return this->height;
+}
+int render::RenderTarget::getSampleCount() const {
+	return this->sampleCount;
+}
+unsigned int render::RenderTarget::getColorTexture() const {
+	return this->colorTexture.getID();
+}
+void render::RenderTarget::checkComplete() {
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		GlState::getInstance()->bindFramebuffer(0);
+		throw IncompleteFramebufferException();
+	}
+}
+
+IncompleteFramebufferException::IncompleteFramebufferException() : std::runtime_error("Render target framebuffer is incomplete") {};
\ No newline at end of file
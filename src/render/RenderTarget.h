@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdexcept>
+
+#include "GpuResource.h"
+
+namespace render {
+
+	class RenderTarget {
+		/*
+			Color texture with a depth buffer that is drawn into instead of the window, so an image can be drawn once and shown many times.
+			With more than one sample, draws go into multisampled buffers instead, and resolve() averages them into the texture.
+			Storage is created by the first resize and created again whenever the size or sample count changes.
+		*/
+		public:
+			RenderTarget();
+
+			// Takes effect on the next resize, clamped to what the driver supports
+			void setSampleCount(int sampleCount);
+			// Returns whether the storage was created again, its contents are undefined until drawn into
+			bool resize(int width, int height);
+
+			// Draws go into the target until the window is bound again
+			void bind();
+			// Makes the texture show what was drawn, only does something when multisampled
+			void resolve();
+			static void bindWindow();
+
+			int getWidth() const;
+			int getHeight() const;
+			int getSampleCount() const;
+			unsigned int getColorTexture() const;
+
+		private:
+			Framebuffer framebuffer;
+			Texture colorTexture;
+			Renderbuffer depthBuffer;
+			// Only when multisampled, the framebuffer above then only holds the texture to resolve into
+			Framebuffer multisampleFramebuffer;
+			Renderbuffer multisampleColorBuffer;
+
+			int width;
+			int height;
+			int sampleCount;
+			int requestedSampleCount;
+
+			void checkComplete();
+	};
+}
+
+struct IncompleteFramebufferException : public std::runtime_error {
+	IncompleteFramebufferException();
+};
\ No newline at end of file
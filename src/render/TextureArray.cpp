@@ -0,0 +1,118 @@
+#include <glad/glad.h>
+#include <algorithm>
+
+#include "TextureArray.h"
+#include "TextureLoader.h"
+#include "GlState.h"
+
+static const int INITIAL_LAYER_CAPACITY = 64;
+static const int BYTES_PER_PIXEL = 4;
+
+static int roundUpToPowerOfTwo(int value) {
+	int result = 1;
+	while (result < value)
+		result *= 2;
+	return result;
+}
+
+// TextureArray
+render::TextureArray::TextureArray(int layerSize) {
+	this->layerSize = roundUpToPowerOfTwo(layerSize);
+	this->layerCapacity = INITIAL_LAYER_CAPACITY;
+	this->needsReallocation = true;
+}
+int render::TextureArray::addLayer(const unsigned char* pixels, int width, int height) {
+	this->images.push_back(Image());
+	int layer = (int)this->images.size() - 1;
+	this->setLayer(layer, pixels, width, height);
+	return layer;
+}
+void render::TextureArray::setLayer(int layer, const unsigned char* pixels, int width, int height) {
+	if (layer < 0 || layer >= (int)this->images.size())
+		throw InvalidTextureLayerException();
+
+	Image* image = &this->images[layer];
+	image->pixels.assign(pixels, pixels + width * height * BYTES_PER_PIXEL);
+	image->width = width;
+	image->height = height;
+	image->isUploaded = false;
+
+	// Larger images get larger layers instead of losing detail
+	int requiredSize = roundUpToPowerOfTwo(std::max(width, height));
+	if (requiredSize > this->layerSize) {
+		this->layerSize = requiredSize;
+		this->needsReallocation = true;
+	}
+	if (layer >= this->layerCapacity) {
+		while (layer >= this->layerCapacity)
+			this->layerCapacity *= 2;
+		this->needsReallocation = true;
+	}
+}
+void render::TextureArray::bind(int textureUnit) {
+	if (this->needsReallocation)
+		this->reallocate();
+
+	GlState::getInstance()->bindTexture(textureUnit, GL_TEXTURE_2D_ARRAY, this->texture.getID());
+
+	bool uploaded = false;
+	for (int layer = 0; layer < (int)this->images.size(); ++layer) {
+		if (!this->images[layer].isUploaded) {
+			this->uploadLayer(layer);
+			uploaded = true;
+		}
+	}
+	if (uploaded)
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+}
+int render::TextureArray::getLayerCount() const {
+	return (int)this->images.size();
+}
+int render::TextureArray::getLayerSize() const {
+	return this->layerSize;
+}
+unsigned int render::TextureArray::getTextureID() const {
+	return this->texture.getID();
+}
+void render::TextureArray::reallocate() {
+	// A new texture object, as the storage of the old one may still be used by queued draws
+	this->texture = Texture::create();
+	GlState::getInstance()->bindTexture(GL_TEXTURE_2D_ARRAY, this->texture.getID());
+
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, this->layerSize, this->layerSize, this->layerCapacity, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+	for (auto it = this->images.begin(); it != this->images.end(); ++it) {
+		it->isUploaded = false;
+	}
+	this->needsReallocation = false;
+}
+void render::TextureArray::uploadLayer(int layer) {
+	Image* image = &this->images[layer];
+	const unsigned char* pixels = image->pixels.data();
+
+	std::vector<unsigned char> scaled;
+	if (image->width != this->layerSize || image->height != this->layerSize) {
+		scaled.resize(this->layerSize * this->layerSize * BYTES_PER_PIXEL);
+		for (int y = 0; y < this->layerSize; ++y) {
+			int sourceY = y * image->height / this->layerSize;
+			for (int x = 0; x < this->layerSize; ++x) {
+				int sourceX = x * image->width / this->layerSize;
+				std::copy_n(&pixels[(sourceY * image->width + sourceX) * BYTES_PER_PIXEL], BYTES_PER_PIXEL, &scaled[(y * this->layerSize + x) * BYTES_PER_PIXEL]);
+			}
+		}
+		pixels = scaled.data();
+	}
+
+	TextureLoader* loader = TextureLoader::getInstance();
+	loader->beginUpload(pixels, this->layerSize * this->layerSize * BYTES_PER_PIXEL);
+	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, this->layerSize, this->layerSize, 1, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+	loader->endUpload();
+	image->isUploaded = true;
+}
+
+InvalidTextureLayerException::InvalidTextureLayerException() : std::runtime_error("Invalid texture array layer") {};
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <stdexcept>
+
+#include "GpuResource.h"
+
+namespace render {
+
+	class TextureArray {
+		/*
+			Stores many small images as the layers of one GL_TEXTURE_2D_ARRAY, so they are all sampled through a single binding.
+			Every layer has the same square size, images of another size are scaled to it with nearest filtering.
+			A copy of each image is kept, so the array can be reallocated when it runs out of layers or needs larger ones.
+			Changes are uploaded the next time the array is bound.
+		*/
+		public:
+			TextureArray(int layerSize);
+
+			// Pixels are RGBA8, rows from top to bottom
+			int addLayer(const unsigned char* pixels, int width, int height);
+			void setLayer(int layer, const unsigned char* pixels, int width, int height);
+
+			void bind(int textureUnit);
+
+			int getLayerCount() const;
+			int getLayerSize() const;
+			unsigned int getTextureID() const;
+
+		private:
+			struct Image {
+				std::vector<unsigned char> pixels;
+				int width = 0;
+				int height = 0;
+				bool isUploaded = false;
+			};
+
+			Texture texture;
+			int layerSize;
+			int layerCapacity;
+			bool needsReallocation;
+
+			std::vector<Image> images;
+
+			void reallocate();
+			void uploadLayer(int layer);
+	};
+}
+
+struct InvalidTextureLayerException : public std::runtime_error {
+	InvalidTextureLayerException();
+};
\ No newline at end of file
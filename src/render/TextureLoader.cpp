@@ -0,0 +1,267 @@
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstring>
+
+#include "TextureLoader.h"
+#include "../import/stb_image.h"
+
+// Increase when decoding changes, so images cached by older versions are decoded again
+static const unsigned int IMAGE_CACHE_VERSION = 1;
+static const std::string IMAGE_CACHE_KIND = "image";
+// Width, height and level count in front of the pixels
+static const int IMAGE_HEADER_SIZE = 3 * sizeof(int);
+static const int BYTES_PER_PIXEL = 4;
+// Larger cached images are decoded again instead, the offsets of their levels wouldn't fit in an int
+static const int MAX_CACHED_IMAGE_SIZE = 8192;
+
+static const int MAX_WORKER_COUNT = 4;
+static const int UPLOAD_BUFFER_COUNT = 3;
+// Decoded images handed out per frame, at least one image is always handed out
+static const int MAX_UPLOAD_BYTES_PER_FRAME = 4 << 20;
+
+// DecodedImage
+const unsigned char* render::DecodedImage::getPixels(int level) const {
+	return this->getData() + this->getLevelOffset(level);
+}
+int render::DecodedImage::getLevelWidth(int level) const {
+	return std::max(1, this->width >> level);
+}
+int render::DecodedImage::getLevelHeight(int level) const {
+	return std::max(1, this->height >> level);
+}
+int render::DecodedImage::getLevelOffset(int level) const {
+	int offset = IMAGE_HEADER_SIZE;
+	for (int i = 0; i < level; ++i) {
+		offset += this->getLevelWidth(i) * this->getLevelHeight(i) * BYTES_PER_PIXEL;
+	}
+	return offset;
+}
+int render::DecodedImage::getPixelDataSize() const {
+	return this->getLevelOffset(this->levelCount) - IMAGE_HEADER_SIZE;
+}
+const unsigned char* render::DecodedImage::getData() const {
+	if (this->cacheEntry)
+		return this->cacheEntry->getPayload();
+	return this->data.data();
+}
+
+// TextureLoader
+render::TextureLoader::TextureLoader(int workerCount) {
+	this->pendingCount = 0;
+	this->isStopping = false;
+	this->nextUploadBuffer = 0;
+
+	for (int i = 0; i < workerCount; ++i) {
+		this->workers.push_back(std::thread(&TextureLoader::runWorker, this));
+	}
+}
+render::TextureLoader::~TextureLoader() {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->isStopping = true;
+	}
+	this->requestAvailable.notify_all();
+
+	for (auto it = this->workers.begin(); it != this->workers.end(); ++it) {
+		it->join();
+	}
+}
+void render::TextureLoader::load(std::string path, std::function<void(DecodedImage* image)> onLoaded) {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->requests.push_back(Request{ path, onLoaded });
+		this->pendingCount++;
+	}
+	this->requestAvailable.notify_one();
+}
+void render::TextureLoader::processLoadedImages() {
+	int uploadedBytes = 0;
+
+	while (uploadedBytes < MAX_UPLOAD_BYTES_PER_FRAME) {
+		Result result;
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			if (this->results.empty())
+				break;
+
+			result = std::move(this->results.front());
+			this->results.pop_front();
+		}
+
+		uploadedBytes += result.image.succeeded ? result.image.getPixelDataSize() : 0;
+		this->handOut(&result);
+	}
+}
+void render::TextureLoader::setDecodedCallback(std::function<void()> onDecoded) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->onDecoded = onDecoded;
+}
+bool render::TextureLoader::hasLoadedImages() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return !this->results.empty();
+}
+int render::TextureLoader::getPendingCount() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->pendingCount;
+}
+void render::TextureLoader::beginUpload(const void* pixels, int size) {
+	if (this->uploadBuffers.empty()) {
+		for (int i = 0; i < UPLOAD_BUFFER_COUNT; ++i) {
+			this->uploadBuffers.push_back(Buffer::create());
+		}
+	}
+
+	Buffer* buffer = &this->uploadBuffers[this->nextUploadBuffer];
+	this->nextUploadBuffer = (this->nextUploadBuffer + 1) % UPLOAD_BUFFER_COUNT;
+
+	// Orphan the previous storage, so the driver doesn't wait for uploads still reading from it
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer->getID());
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+
+	void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (mapped != nullptr) {
+		std::memcpy(mapped, pixels, size);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+	} else {
+		glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, size, pixels);
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+}
+void render::TextureLoader::endUpload() {
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+render::TextureLoader* render::TextureLoader::getInstance() {
+	static TextureLoader* loader = new TextureLoader(std::max(1, std::min(MAX_WORKER_COUNT, (int)std::thread::hardware_concurrency() - 1)));
+	return loader;
+}
+void render::TextureLoader::runWorker() {
+	while (true) {
+		Request request;
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->requestAvailable.wait(lock, [this] { return this->isStopping || !this->requests.empty(); });
+			if (this->isStopping)
+				return;
+
+			request = std::move(this->requests.front());
+			this->requests.pop_front();
+		}
+
+		Result result;
+		result.image = TextureLoader::decode(request.path);
+		result.onLoaded = std::move(request.onLoaded);
+
+		std::function<void()> onDecoded;
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->results.push_back(std::move(result));
+			onDecoded = this->onDecoded;
+		}
+		if (onDecoded)
+			onDecoded();
+	}
+}
+void render::TextureLoader::handOut(Result* result) {
+	if (result->onLoaded)
+		result->onLoaded(&result->image);
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->pendingCount--;
+}
+render::DecodedImage render::TextureLoader::decode(std::string path) {
+	DecodedImage image;
+	image.path = path;
+
+	std::vector<unsigned char> fileContents;
+	if (!AssetCache::readFile(path, &fileContents))
+		return image;
+
+	// Hashing the file is much cheaper than decoding it
+	AssetCache* cache = AssetCache::getInstance();
+	unsigned long long key = AssetCache::hash(fileContents.data(), fileContents.size());
+	key = AssetCache::hash(&IMAGE_CACHE_VERSION, sizeof(IMAGE_CACHE_VERSION), key);
+
+	if (TextureLoader::readCachedImage(cache->find(IMAGE_CACHE_KIND, key), &image))
+		return image;
+
+	int numberOfChannels;
+	unsigned char* pixels = stbi_load_from_memory(fileContents.data(), (int)fileContents.size(), &image.width, &image.height, &numberOfChannels, BYTES_PER_PIXEL);
+	if (!pixels)
+		return image;
+
+	TextureLoader::createImageData(pixels, &image);
+	stbi_image_free(pixels);
+
+	cache->store(IMAGE_CACHE_KIND, key, image.data.data(), image.data.size());
+	return image;
+}
+bool render::TextureLoader::readCachedImage(std::shared_ptr<AssetCache::Entry> entry, DecodedImage* image) {
+	if (!entry || entry->getPayloadSize() < IMAGE_HEADER_SIZE)
+		return false;
+
+	const int* header = (const int*)entry->getPayload();
+	image->width = header[0];
+	image->height = header[1];
+	image->levelCount = header[2];
+
+	// Entries can be cut short or damaged, so the header is checked before anything relies on it
+	if (image->width <= 0 || image->height <= 0 || image->width > MAX_CACHED_IMAGE_SIZE || image->height > MAX_CACHED_IMAGE_SIZE)
+		return false;
+
+	// As many levels as createImageData makes, halving until both sides are a single pixel
+	int expectedLevelCount = 1;
+	while ((std::max(image->width, image->height) >> expectedLevelCount) > 0)
+		expectedLevelCount++;
+	if (image->levelCount != expectedLevelCount)
+		return false;
+
+	size_t expectedSize = IMAGE_HEADER_SIZE;
+	for (int level = 0; level < image->levelCount; ++level) {
+		expectedSize += (size_t)image->getLevelWidth(level) * (size_t)image->getLevelHeight(level) * BYTES_PER_PIXEL;
+	}
+	if (expectedSize != entry->getPayloadSize())
+		return false;
+
+	image->cacheEntry = entry;
+	image->succeeded = true;
+	return true;
+}
+void render::TextureLoader::createImageData(const unsigned char* pixels, DecodedImage* image) {
+	// Halve until both sides are a single pixel
+	image->levelCount = 1;
+	while (image->getLevelWidth(image->levelCount - 1) > 1 || image->getLevelHeight(image->levelCount - 1) > 1)
+		image->levelCount++;
+
+	image->data.resize(image->getLevelOffset(image->levelCount));
+	int header[3] = { image->width, image->height, image->levelCount };
+	std::memcpy(image->data.data(), header, IMAGE_HEADER_SIZE);
+	std::memcpy(image->data.data() + IMAGE_HEADER_SIZE, pixels, image->width * image->height * BYTES_PER_PIXEL);
+
+	// Every mipmap averages blocks of two by two pixels of the level before it
+	for (int level = 1; level < image->levelCount; ++level) {
+		const unsigned char* source = image->data.data() + image->getLevelOffset(level - 1);
+		unsigned char* destination = image->data.data() + image->getLevelOffset(level);
+		int sourceWidth = image->getLevelWidth(level - 1);
+		int sourceHeight = image->getLevelHeight(level - 1);
+		int width = image->getLevelWidth(level);
+		int height = image->getLevelHeight(level);
+
+		for (int y = 0; y < height; ++y) {
+			int y0 = std::min(y * 2, sourceHeight - 1);
+			int y1 = std::min(y * 2 + 1, sourceHeight - 1);
+			for (int x = 0; x < width; ++x) {
+				int x0 = std::min(x * 2, sourceWidth - 1);
+				int x1 = std::min(x * 2 + 1, sourceWidth - 1);
+				for (int channel = 0; channel < BYTES_PER_PIXEL; ++channel) {
+					int sum = source[(y0 * sourceWidth + x0) * BYTES_PER_PIXEL + channel]
+						+ source[(y0 * sourceWidth + x1) * BYTES_PER_PIXEL + channel]
+						+ source[(y1 * sourceWidth + x0) * BYTES_PER_PIXEL + channel]
+						+ source[(y1 * sourceWidth + x1) * BYTES_PER_PIXEL + channel];
+					destination[(y * width + x) * BYTES_PER_PIXEL + channel] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+	}
+	image->succeeded = true;
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#include "GpuResource.h"
+#include "../import/AssetCache.h"
+
+namespace render {
+
+	struct DecodedImage {
+		std::string path;
+		int width = 0;
+		int height = 0;
+		int levelCount = 0;		// The image itself followed by its mipmaps
+		bool succeeded = false;
+
+		// RGBA8 with rows from top to bottom, all levels follow each other
+		const unsigned char* getPixels(int level) const;
+		int getLevelWidth(int level) const;
+		int getLevelHeight(int level) const;
+		int getLevelOffset(int level) const;
+		int getPixelDataSize() const;
+
+		// Either decoded into memory, or mapped from the asset cache
+		std::vector<unsigned char> data;
+		std::shared_ptr<AssetCache::Entry> cacheEntry;
+
+		const unsigned char* getData() const;
+	};
+
+	class TextureLoader {
+		/*
+			Decodes image files on worker threads, so loading many textures doesn't block drawing.
+			Finished images are handed back on the GL thread, where they are uploaded through pixel buffer objects.
+			Callers get their texture right away and fill it in once the image arrives.
+		*/
+		public:
+			TextureLoader(int workerCount);
+			~TextureLoader();
+
+			// onLoaded is called from processLoadedImages, also when decoding failed
+			void load(std::string path, std::function<void(DecodedImage* image)> onLoaded);
+
+			// Hands finished images to their callbacks, has to be called with the GL context current
+			void processLoadedImages();
+			// Whether images are waiting to be handed out, uploads are spread over frames
+			bool hasLoadedImages();
+			int getPendingCount();
+			// Called on a worker thread whenever an image is ready, so a waiting main loop can wake up
+			void setDecodedCallback(std::function<void()> onDecoded);
+
+			// Copies pixels into a pixel buffer object and leaves it bound to GL_PIXEL_UNPACK_BUFFER,
+			// texture uploads in between read from it with offset 0
+			void beginUpload(const void* pixels, int size);
+			void endUpload();
+
+			// Shared by all textures, created on first use
+			static TextureLoader* getInstance();
+
+		private:
+			struct Request {
+				std::string path;
+				std::function<void(DecodedImage* image)> onLoaded;
+			};
+			struct Result {
+				DecodedImage image;
+				std::function<void(DecodedImage* image)> onLoaded;
+			};
+
+			std::vector<std::thread> workers;
+			std::mutex mutex;
+			std::condition_variable requestAvailable;
+			std::deque<Request> requests;
+			std::deque<Result> results;
+			int pendingCount;
+			bool isStopping;
+			std::function<void()> onDecoded;
+
+			// Uploads cycle through these, so a new upload doesn't wait for the previous one to be read
+			std::vector<Buffer> uploadBuffers;
+			int nextUploadBuffer;
+
+			void runWorker();
+			void handOut(Result* result);
+
+			static DecodedImage decode(std::string path);
+			static bool readCachedImage(std::shared_ptr<AssetCache::Entry> entry, DecodedImage* image);
+			static void createImageData(const unsigned char* pixels, DecodedImage* image);
+	};
+}
\ No newline at end of file